@@ -0,0 +1,47 @@
+#include <cstdlib>
+#include <cxxopts.hpp>
+#include <engine/enginemain.h>
+#include <faio/faio.h>
+#include <iostream>
+#include <misc/misc.h>
+#include <settings/settings.h>
+
+// Dedicated server. Runs the game simulation and accepts clients exactly like a hosting freeablo does, but with no window,
+// renderer or audio, so it can run on a machine with no display. Needs the game data to be set up, same as freeablo itself.
+
+int main(int argc, char** argv)
+{
+    Misc::saveArgv0(argv[0]);
+
+    cxxopts::Options desc("faserver", "Headless freeablo multiplayer server");
+    desc.add_options()("h,help", "Print help")("seed", "Seed for level generation", cxxopts::value<uint32_t>()->default_value("0"));
+
+    cxxopts::ParseResult variables;
+    try
+    {
+        variables = desc.parse(argc, argv);
+    }
+    catch (cxxopts::OptionParseException& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl << std::endl;
+        std::cerr << desc.help() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (variables.count("help"))
+    {
+        std::cout << desc.help() << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    Settings::Settings settings;
+    if (!settings.loadUserSettings())
+        return EXIT_FAILURE;
+
+    FAIO::ScopedInitFAIO faioInit(settings.get<std::string>("Game", "PathMPQ"));
+
+    Engine::EngineMain engine;
+    engine.runHeadless(variables);
+
+    return EXIT_SUCCESS;
+}
@@ -2,7 +2,9 @@
 #include "../faaudio/audiomanager.h"
 #include "../fagui/guimanager.h"
 #include "../falevelgen/levelgen.h"
-#include "../fasavegame/gameloader.h"
+#include "../farender/spriteloader.h"
+#include "../fasavegame/savegame.h"
+#include "../fasavegame/savejournal.h"
 #include "../faworld/enums.h"
 #include "../faworld/itemfactory.h"
 #include "../faworld/player.h"
@@ -14,6 +16,7 @@
 #include "net/server.h"
 #include "threadmanager.h"
 #include <cel/celdecoder.h>
+#include <chrono>
 #include <cxxopts.hpp>
 #include <enet/enet.h>
 #include <functional>
@@ -21,14 +24,61 @@
 #include <iostream>
 #include <misc/misc.h>
 #include <random/random.h>
-#include <serial/textstream.h>
 #include <thread>
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <csignal>
+#endif
+
 namespace Engine
 {
+    static constexpr FAWorld::Tick AUTOSAVE_INTERVAL = FAWorld::World::ticksPerSecond * 60;
+
+    using clock = std::chrono::steady_clock;
+
+    static void sleepUntilNextTick(clock::time_point frameStartTime)
+    {
+        clock::time_point frameEndTargetTime = frameStartTime + std::chrono::milliseconds(1000 / FAWorld::World::ticksPerSecond);
+        clock::duration remainingTickTime = frameEndTargetTime - clock::now();
+        auto remainingMilliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(remainingTickTime);
+
+        if (remainingMilliseconds.count() < 0)
+            std::cerr << "tick time exceeded by " << -remainingMilliseconds.count() << "ms" << std::endl;
+        else
+            std::this_thread::sleep_until(frameEndTargetTime);
+    }
+
+    // Lets a dedicated server be shut down cleanly with ctrl+c or a kill, instead of possibly being stopped halfway through writing the autosave
+#ifdef _WIN32
+    static BOOL WINAPI onConsoleControl(DWORD)
+    {
+        if (EngineMain* engine = EngineMain::get())
+            engine->stop();
+        return TRUE;
+    }
+
+    static void installStopHandler() { SetConsoleCtrlHandler(onConsoleControl, TRUE); }
+#else
+    static void onStopSignal(int)
+    {
+        if (EngineMain* engine = EngineMain::get())
+            engine->stop();
+    }
+
+    static void installStopHandler()
+    {
+        std::signal(SIGINT, onStopSignal);
+        std::signal(SIGTERM, onStopSignal);
+    }
+#endif
+
     EngineMain* EngineMain::singletonInstance = nullptr;
 
-    EngineMain::EngineMain()
+    EngineMain::EngineMain() : mBackgroundSaver(std::make_unique<FASaveGame::BackgroundSaver>())
     {
         release_assert(singletonInstance == nullptr);
         singletonInstance = this;
@@ -47,11 +97,7 @@ namespace Engine
         auto resolutionHeight = mSettings.get<size_t>("Display", "resolutionHeight");
         const bool fullscreen = mSettings.get<bool>("Display", "fullscreen");
 
-        auto pathEXE = mSettings.get<std::string>("Game", "PathEXE");
-        if (pathEXE.empty())
-            pathEXE = "Diablo.exe";
-        mExe = std::make_unique<DiabloExe::DiabloExe>(pathEXE);
-        if (!mExe->isLoaded())
+        if (!loadExe())
             return;
 
         Engine::ThreadManager threadManager;
@@ -66,6 +112,81 @@ namespace Engine
         mainThread.join();
     }
 
+    void EngineMain::runHeadless(const cxxopts::ParseResult& variables)
+    {
+        if (!mSettings.loadUserSettings())
+            return;
+
+        Cel::CelDecoder::loadConfigFiles();
+
+        if (!loadExe())
+            return;
+
+        Engine::ThreadManager threadManager(true);
+
+        // Animation lengths affect the simulation, so we still need to know how many frames each sprite has
+        FARender::SpriteLoader spriteLoader(*mExe);
+        spriteLoader.loadMetadataOnly();
+
+        auto seed = uint32_t(time(nullptr));
+        if (variables["seed"].as<uint32_t>() != 0)
+            seed = variables["seed"].as<uint32_t>();
+
+        startDedicatedServer(seed);
+        std::cout << "Server running, seed " << seed << std::endl;
+
+        installStopHandler();
+
+        while (!mDone)
+        {
+            clock::time_point frameStartTime = clock::now();
+            updateDedicatedServer();
+            sleepUntilNextTick(frameStartTime);
+        }
+
+        std::cout << "Server stopping" << std::endl;
+
+        // Save what has changed since the last autosave, and make sure it's all on disk before we exit.
+        // An autosave that is still being written would make this one get skipped, so let it finish first.
+        if (mAutosaveJournal)
+            mAutosaveJournal->waitUntilDone();
+        autosave();
+        mAutosaveJournal->waitUntilDone();
+    }
+
+    void EngineMain::startDedicatedServer(uint32_t seed)
+    {
+        // The server has to go first, so its port is free for the new one
+        mMultiplayer.reset();
+        mLocalInputHandler.reset();
+        mPlayerFactory.reset();
+
+        mWorld = std::make_unique<FAWorld::World>(*mExe, seed);
+        mPlayerFactory = std::make_unique<FAWorld::PlayerFactory>(*mExe, mWorld->getItemFactory());
+        mLocalInputHandler = std::make_unique<LocalInputHandler>(*mWorld);
+
+        mWorld->generateLevels();
+
+        mInGame = true;
+        mMultiplayer = std::make_unique<Server>(*mWorld, *mLocalInputHandler);
+    }
+
+    void EngineMain::updateDedicatedServer()
+    {
+        mMultiplayer->update();
+        runAvailableTicks();
+    }
+
+    bool EngineMain::loadExe()
+    {
+        auto pathEXE = mSettings.get<std::string>("Game", "PathEXE");
+        if (pathEXE.empty())
+            pathEXE = "Diablo.exe";
+        mExe = std::make_unique<DiabloExe::DiabloExe>(pathEXE);
+
+        return mExe->isLoaded();
+    }
+
     void EngineMain::runGameLoop(const cxxopts::ParseResult& variables)
     {
         FARender::Renderer& renderer = *FARender::Renderer::get();
@@ -102,7 +223,7 @@ namespace Engine
         }
         else
         {
-            mMultiplayer = std::make_unique<Client>(*mLocalInputHandler, variables["connect"].as<std::string>());
+            mMultiplayer = std::make_unique<Client>(*mLocalInputHandler, variables["connect"].as<std::string>(), variables["spectate"].as<bool>());
         }
 
         mGuiManager = std::make_unique<FAGui::GuiManager>(*this);
@@ -118,8 +239,6 @@ namespace Engine
         if (currentLevel != -1)
             mWorld->setLevel(currentLevel);
 
-        using clock = std::chrono::steady_clock;
-
         int32_t lastLevelIndex = -1;
 
         // Main game logic loop
@@ -135,25 +254,13 @@ namespace Engine
 
             if (mInGame && (!mPaused || mMultiplayer->isMultiplayer()))
             {
-                std::optional<std::vector<FAWorld::PlayerInput>> inputs;
+                runAvailableTicks();
 
-                do
+                if (mWorld->getCurrentLevelIndex() != lastLevelIndex)
                 {
-                    inputs = mMultiplayer->getAndClearInputs(mWorld->getCurrentTick());
-
-                    if (inputs)
-                    {
-                        mMultiplayer->verify(mWorld->getCurrentTick());
-                        mWorld->update(mNoclip, *inputs);
-
-                        if (mWorld->getCurrentLevelIndex() != lastLevelIndex)
-                        {
-                            mWorld->playLevelMusic(mWorld->getCurrentLevelIndex());
-                            lastLevelIndex = mWorld->getCurrentLevelIndex();
-                        }
-                    }
-
-                } while (inputs);
+                    mWorld->playLevelMusic(mWorld->getCurrentLevelIndex());
+                    lastLevelIndex = mWorld->getCurrentLevelIndex();
+                }
             }
 
             nk_context* ctx = renderer.getNuklearContext();
@@ -193,20 +300,27 @@ namespace Engine
             if (state)
                 renderer.setCurrentState(state);
 
-            clock::time_point frameEndTargetTime = frameStartTime + std::chrono::milliseconds(1000 / FAWorld::World::ticksPerSecond);
-            clock::duration remainingTickTime = frameEndTargetTime - clock::now();
-            auto remainingMilliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(remainingTickTime);
-
-            if (remainingMilliseconds.count() < 0)
-                std::cerr << "tick time exceeded by " << -remainingMilliseconds.count() << "ms" << std::endl;
-            else
-                std::this_thread::sleep_until(frameEndTargetTime);
+            // A client that has just joined from an old snapshot, or fallen behind, runs its ticks as fast as it can until it catches up
+            if (!mMultiplayer || !mMultiplayer->isCatchingUp())
+                sleepUntilNextTick(frameStartTime);
         }
 
         renderer.stop();
         renderer.waitUntilDone();
     }
 
+    void EngineMain::runAvailableTicks()
+    {
+        while (const std::vector<FAWorld::PlayerInput>* inputs = mMultiplayer->getInputs(mWorld->getCurrentTick()))
+        {
+            mMultiplayer->verify(mWorld->getCurrentTick());
+            mWorld->update(mNoclip, *inputs);
+
+            if (mMultiplayer->isServer() && mWorld->getCurrentTick() % AUTOSAVE_INTERVAL == 0)
+                autosave();
+        }
+    }
+
     void EngineMain::notify(KeyboardInputAction action)
     {
         if (mGuiManager->isPauseBlocked())
@@ -256,29 +370,39 @@ namespace Engine
 
     void EngineMain::startGameFromSave(const std::string& savePath)
     {
-        FILE* saveFile = fopen(savePath.c_str(), "rb");
-        release_assert(saveFile);
-
-        fseek(saveFile, 0, SEEK_END);
-        size_t size = ftell(saveFile);
-        fseek(saveFile, 0, SEEK_SET);
-
-        std::string tmp;
-        tmp.resize(size);
-
-        fread((void*)tmp.data(), 1, size, saveFile);
-        fclose(saveFile);
+        release_assert(FASaveGame::loadSaveGame(savePath, *mWorld));
+        mWorld->setFirstPlayerAsCurrent();
 
-        Serial::TextReadStream stream(tmp);
-        FASaveGame::GameLoader loader(stream);
+        mInGame = true;
+        mMultiplayer = std::make_unique<Server>(*mWorld, *mLocalInputHandler);
+    }
 
-        mWorld->load(loader);
+    void EngineMain::startGameFromAutosave()
+    {
+        release_assert(FASaveGame::SaveJournal::load(AUTOSAVE_PATH, *mWorld));
         mWorld->setFirstPlayerAsCurrent();
 
         mInGame = true;
         mMultiplayer = std::make_unique<Server>(*mWorld, *mLocalInputHandler);
     }
 
+    void EngineMain::autosave()
+    {
+        // A new journal starts with a full snapshot, so we don't need to care about what was in the file before
+        if (!mAutosaveJournal)
+            mAutosaveJournal = std::make_unique<FASaveGame::SaveJournal>(AUTOSAVE_PATH);
+
+        // The previous entry has normally finished long ago. If not, skipping this one is fine, as the next one picks up all changed levels.
+        if (!mAutosaveJournal->startAppend(*mWorld))
+            std::cerr << "Not autosaving, previous autosave is still being written" << std::endl;
+    }
+
+    void EngineMain::saveGame(const std::string& savePath)
+    {
+        if (!mBackgroundSaver->startSave(savePath, *mWorld))
+            std::cerr << "Not saving " << savePath << ", previous save is still being written" << std::endl;
+    }
+
     void EngineMain::startMultiplayerGame(const std::string& serverAddress) { mMultiplayer = std::make_unique<Client>(*mLocalInputHandler, serverAddress); }
 
     const DiabloExe::DiabloExe& EngineMain::exe() const { return *mExe; }
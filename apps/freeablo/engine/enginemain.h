@@ -1,6 +1,7 @@
 #pragma once
 #include "../faworld/playerfactory.h"
 #include "engineinputmanager.h"
+#include <atomic>
 #include <memory>
 #include <settings/settings.h>
 
@@ -24,6 +25,12 @@ namespace cxxopts
     class ParseResult;
 }
 
+namespace FASaveGame
+{
+    class BackgroundSaver;
+    class SaveJournal;
+}
+
 namespace Engine
 {
     class LocalInputHandler;
@@ -35,6 +42,12 @@ namespace Engine
         EngineMain();
         ~EngineMain() override;
         void run(const cxxopts::ParseResult& variables);
+        // Runs a dedicated server, with no window, renderer or audio. Nobody plays on the server itself, so there is no current player.
+        void runHeadless(const cxxopts::ParseResult& variables);
+        // The parts of runHeadless() that tools driving a server themselves need. startDedicatedServer() replaces any previous game,
+        // and needs mExe and a SpriteLoader to be set up. updateDedicatedServer() should be called once per tick.
+        void startDedicatedServer(uint32_t seed);
+        void updateDedicatedServer();
         void stop();
         void togglePause();
         void toggleNoclip();
@@ -43,6 +56,9 @@ namespace Engine
         // TODO: replace with enums
         void startGame(FAWorld::PlayerClass characterClass);
         void startGameFromSave(const std::string& savePath);
+        void startGameFromAutosave();
+        // Saving finishes in the background, this only blocks for as long as it takes to serialise the world
+        void saveGame(const std::string& savePath);
         void startMultiplayerGame(const std::string& serverAddress);
         const DiabloExe::DiabloExe& exe() const;
         bool isPaused() const;
@@ -50,13 +66,21 @@ namespace Engine
         static EngineMain* get() { return singletonInstance; }
         LocalInputHandler* getLocalInputHandler() { return mLocalInputHandler.get(); }
 
+        static constexpr const char* AUTOSAVE_PATH = "autosave.journal";
+
     private:
+        bool loadExe();
         void runGameLoop(const cxxopts::ParseResult& variables);
+        // Runs the simulation for as many ticks as we have inputs for
+        void runAvailableTicks();
+        void autosave();
 
     private:
         static EngineMain* singletonInstance;
 
         std::unique_ptr<LocalInputHandler> mLocalInputHandler;
+        std::unique_ptr<FASaveGame::BackgroundSaver> mBackgroundSaver;
+        std::unique_ptr<FASaveGame::SaveJournal> mAutosaveJournal;
 
     public: // HACK
         std::unique_ptr<FAWorld::World> mWorld;
@@ -65,7 +89,7 @@ namespace Engine
         std::unique_ptr<DiabloExe::DiabloExe> mExe;
         std::unique_ptr<FAWorld::PlayerFactory> mPlayerFactory;
         std::unique_ptr<FAGui::GuiManager> mGuiManager;
-        bool mDone = false;
+        std::atomic_bool mDone = false; ///< atomic so stop() can be called from a signal handler, see runHeadless()
         bool mPaused = false;
         bool mNoclip = false;
         bool mInGame = false;
@@ -6,13 +6,18 @@
 #include "../../faworld/world.h"
 #include "../enginemain.h"
 #include "../localinputhandler.h"
+#include "server.h"
+#include <algorithm>
+#include <cinttypes>
 #include <iostream>
 #include <misc/assert.h>
+#include <serial/packedstream.h>
 #include <serial/textstream.h>
 
 namespace Engine
 {
-    Client::Client(LocalInputHandler& localInputHandler, const std::string& serverAddress) : mLocalInputHandler(localInputHandler)
+    Client::Client(LocalInputHandler& localInputHandler, const std::string& serverAddress, bool spectator)
+        : mSpectator(spectator), mLocalInputHandler(localInputHandler), mInputHistory(Server::MAX_INPUTS_PER_TICK)
     {
         if (0 != enet_initialize())
         {
@@ -22,7 +27,7 @@ namespace Engine
         enet_address_set_host(&mAddress, serverAddress.c_str());
         mHost = enet_host_create(nullptr, 32, 2, 0, 0);
         mHost->checksum = enet_crc32;
-        mServerPeer = enet_host_connect(mHost, &mAddress, CHANNEL_ID_END, 0);
+        mServerPeer = enet_host_connect(mHost, &mAddress, CHANNEL_ID_END, uint32_t(spectator ? ConnectType::Spectator : ConnectType::Player));
     }
 
     Client::~Client()
@@ -35,19 +40,22 @@ namespace Engine
         enet_deinitialize();
     }
 
-    std::optional<std::vector<FAWorld::PlayerInput>> Client::getAndClearInputs(FAWorld::Tick tick)
+    const std::vector<FAWorld::PlayerInput>* Client::getInputs(FAWorld::Tick tick)
     {
-        if (!mInputs.count(tick))
-            return std::nullopt;
+        if (mTicksToRunThisFrame <= 0 || !mInputHistory.contains(tick))
+            return nullptr;
 
-        if (mDoFullVerify && !mServerStatesForFullVerify.count(tick))
-            return std::nullopt;
-
-        std::vector<FAWorld::PlayerInput> retval;
-        retval.swap(mInputs[tick]);
-        mInputs.erase(tick);
+        // Running hundreds of ticks at once (after joining from an old snapshot, for example) would freeze the game, and stop us
+        // talking to the server, so we stop once we've used up a frame, and let the game loop come back for more without sleeping.
+        if (mTicksRunThisFrame > 0 && std::chrono::steady_clock::now() >= mCatchUpFrameEnd)
+        {
+            mCatchingUp = true;
+            return nullptr;
+        }
 
-        return retval;
+        mTicksToRunThisFrame--;
+        mTicksRunThisFrame++;
+        return &mInputHistory.get(tick);
     }
 
     void Client::update()
@@ -55,69 +63,147 @@ namespace Engine
         ENetEvent event;
 
         while (enet_host_service(mHost, &event, 0))
+            handleEvent(event);
+
+        // Spectators watch the first player, and move on to the next one when they leave
+        FAWorld::World& world = *EngineMain::get()->mWorld;
+        if (mMyPlayerId != -1 && !world.getCurrentPlayer())
+            findMyPlayer();
+        else if (mSpectator && EngineMain::get()->mInGame && !world.getCurrentPlayer() && !world.getPlayers().empty())
+            world.setFirstPlayerAsCurrent();
+
+        if (EngineMain::get()->mInGame && EngineMain::get()->mWorld->getCurrentTick() != mLastTickISentInputsOn)
+        {
+            sendClientUpdate();
+            mLastTickISentInputsOn = EngineMain::get()->mWorld->getCurrentTick();
+        }
+
+        // The server schedules inputs ahead by its input delay, so they arrive before we need them. We run one tick per frame, which leaves
+        // the ones in hand to cover for late packets, but if we have more than the delay, we've fallen behind (or just joined), so we run
+        // the extra ones as fast as we can, see getInputs().
+        FAWorld::Tick currentTick = EngineMain::get()->mWorld->getCurrentTick();
+        FAWorld::Tick ticksInHand = 0;
+        while (mInputHistory.contains(currentTick + ticksInHand))
+            ticksInHand++;
+
+        mTicksToRunThisFrame = std::max(FAWorld::Tick(1), ticksInHand - mInputDelay);
+
+        mCatchUpFrameEnd = std::chrono::steady_clock::now() + CATCH_UP_FRAME_TIME;
+        mTicksRunThisFrame = 0;
+        mCatchingUp = false;
+    }
+
+    void Client::handleEvent(const ENetEvent& event)
+    {
+        switch (event.type)
         {
-            switch (event.type)
+            case ENET_EVENT_TYPE_RECEIVE:
+            {
+                this->processServerPacket(event);
+                enet_packet_destroy(event.packet);
+                break;
+            }
+            case ENET_EVENT_TYPE_DISCONNECT:
+            {
+                if (!mConnected)
+                    mConnectionFailed = true;
+                mConnected = false;
+                break;
+            }
+            case ENET_EVENT_TYPE_NONE:
+            {
+                break;
+            }
+            case ENET_EVENT_TYPE_CONNECT:
             {
-                case ENET_EVENT_TYPE_RECEIVE:
-                {
-                    this->processServerPacket(event);
-                    break;
-                }
-                case ENET_EVENT_TYPE_DISCONNECT:
-                {
-                    if (!mConnected)
-                        mConnectionFailed = true;
-                    mConnected = false;
-                    break;
-                }
-                case ENET_EVENT_TYPE_NONE:
-                {
-                    break;
-                }
-                case ENET_EVENT_TYPE_CONNECT:
-                {
-                    mConnected = true;
-                    enet_peer_timeout(mServerPeer, 99999, 99999, 99999);
-                    break;
-                }
-                default:
-                    invalid_enum(ENetEventType, event.type);
+                mConnected = true;
+                enet_peer_timeout(mServerPeer, 99999, 99999, 99999);
+                break;
             }
+            default:
+                invalid_enum(ENetEventType, event.type);
         }
+    }
 
-        if (EngineMain::get()->mInGame && EngineMain::get()->mWorld->getCurrentTick() != mLastTickISentInputsOn)
+    void Client::waitForLevel(int32_t levelIndex)
+    {
+        // We're in the middle of a world update here, so there's no way to skip the tick, we just have to block until the level arrives.
+        // Levels are sent in the order players are likely to need them, so this should be rare.
+        while (EngineMain::get()->mWorld->isLevelPending(levelIndex))
         {
-            sendClientUpdate();
-            mLastTickISentInputsOn = EngineMain::get()->mWorld->getCurrentTick();
+            if (!mConnected)
+                message_and_abort_fmt("lost connection to server while waiting for level %d\n", levelIndex);
+
+            ENetEvent event;
+            if (enet_host_service(mHost, &event, 100) > 0)
+                handleEvent(event);
         }
     }
 
     void Client::verify(FAWorld::Tick tick)
     {
-        if (!mDoFullVerify)
+        if (tick < mFirstVerifiedTick)
             return;
 
+        mLocalChecksums[tick] = calculateWorldChecksums(*EngineMain::get()->mWorld);
+        compareChecksums();
+    }
+
+    void Client::compareChecksums()
+    {
+        while (!mServerChecksums.empty())
+        {
+            auto serverIt = mServerChecksums.begin();
+            FAWorld::Tick tick = serverIt->first;
+
+            // The server only starts sending checksums once it knows we have the map, so we can have some older local ones that will never be checked
+            while (!mLocalChecksums.empty() && mLocalChecksums.begin()->first < tick)
+                mLocalChecksums.erase(mLocalChecksums.begin());
+
+            auto localIt = mLocalChecksums.find(tick);
+            if (localIt == mLocalChecksums.end())
+                return;
+
+            const WorldChecksums& server = serverIt->second;
+            const WorldChecksums& local = localIt->second;
+
+            for (const auto& pair : server)
+            {
+                auto it = local.find(pair.first);
+                if (it == local.end() || it->second != pair.second)
+                    onDesync(tick, pair.first);
+            }
+
+            for (const auto& pair : local)
+            {
+                if (!server.count(pair.first))
+                    onDesync(tick, pair.first);
+            }
+
+            mServerChecksums.erase(serverIt);
+            mLocalChecksums.erase(localIt);
+        }
+    }
+
+    void Client::onDesync(FAWorld::Tick tick, int32_t levelIndex)
+    {
+        // We only have checksums from the server, so all we can dump is our own state. Comparing it to a save made by the server
+        // at the same tick is the best way to find what went wrong.
         Serial::TextWriteStream worldStream;
         FASaveGame::GameSaver saver(worldStream);
         EngineMain::get()->mWorld->save(saver);
 
         auto worldData = worldStream.getData();
-        std::string strData(reinterpret_cast<const char*>(worldData.first), worldData.second);
-
-        if (strData != mServerStatesForFullVerify[tick])
+        if (FILE* f = fopen("CLIENT.txt", "wb"))
         {
-            FILE* f = fopen("SERVER.txt", "wb");
-            fwrite(mServerStatesForFullVerify[tick].data(), 1, mServerStatesForFullVerify[tick].size(), f);
-            fclose(f);
-
-            f = fopen("CLIENT.txt", "wb");
-            fwrite(strData.data(), 1, strData.size(), f);
+            fwrite(worldData.first, 1, worldData.second, f);
             fclose(f);
-
-            message_and_abort("desync detected");
         }
 
-        mServerStatesForFullVerify.erase(tick);
+        if (levelIndex == GLOBALS_CHECKSUM_INDEX)
+            message_and_abort_fmt("desync detected in world globals on tick %" PRId64 "\n", tick);
+        else
+            message_and_abort_fmt("desync detected on level %d on tick %" PRId64 "\n", levelIndex, tick);
     }
 
     bool Client::isPlayerRegistered(uint32_t peerId) const { return mRegisteredClientIds.count(peerId) != 0; }
@@ -126,7 +212,7 @@ namespace Engine
 
     void Client::processServerPacket(const ENetEvent& event)
     {
-        Serial::TextReadStream stream(std::string(reinterpret_cast<const char*>(event.packet->data), event.packet->dataLength));
+        Serial::PackedReadStream stream(event.packet->data, event.packet->dataLength);
         FASaveGame::GameLoader loader(stream);
 
         MessageType type = MessageType(loader.load<uint8_t>());
@@ -152,6 +238,12 @@ namespace Engine
                 return;
             }
 
+            case MessageType::LevelToClient:
+            {
+                receiveLevel(loader);
+                return;
+            }
+
             case MessageType::ClientUpdateToServer:
             case MessageType::AcknowledgeMapToServer:
                 invalid_enum(MessageType, type);
@@ -164,53 +256,128 @@ namespace Engine
     {
         puts("RECEIVED MAP\n");
 
-        mDoFullVerify = loader.load<bool>();
+        FAWorld::World& world = *EngineMain::get()->mWorld;
+
+        // see Server::sendMapToPeer for the format
         int32_t myPlayerId = loader.load<int32_t>();
-        EngineMain::get()->mWorld->load(loader);
-        EngineMain::get()->mWorld->addCurrentPlayer(static_cast<FAWorld::Player*>(EngineMain::get()->mWorld->getActorById(myPlayerId)));
+        FAWorld::Tick serverTick = loader.load<FAWorld::Tick>();
+        mFirstVerifiedTick = loader.load<FAWorld::Tick>();
+        WorldChunkReader globalsReader(loader.load<std::string>());
 
-        auto myPlayer = EngineMain::get()->mWorld->getCurrentPlayer();
-        release_assert(myPlayer->getLevel()->isPassable(myPlayer->mMoveHandler.getCurrentPosition().current(), myPlayer));
+        std::vector<std::unique_ptr<WorldChunkReader>> levelReaders;
+        std::map<int32_t, FASaveGame::GameLoader*> levelLoaders;
 
-        Serial::TextWriteStream stream;
-        FASaveGame::GameSaver saver(stream);
+        uint32_t levelCount = loader.load<uint32_t>();
+        for (uint32_t i = 0; i < levelCount; i++)
+        {
+            int32_t levelIndex = loader.load<int32_t>();
+            levelReaders.push_back(std::make_unique<WorldChunkReader>(loader.load<std::string>()));
+            levelLoaders[levelIndex] = &levelReaders.back()->getLoader();
+        }
+
+        world.load(globalsReader.getLoader(), levelLoaders);
+        release_assert(world.getCurrentTick() == serverTick);
+
+        uint32_t pendingLevelCount = loader.load<uint32_t>();
+        for (uint32_t i = 0; i < pendingLevelCount; i++)
+            world.addPendingLevel(loader.load<int32_t>());
+
+        // Spectators don't have a player, the server sends -1 instead
+        mMyPlayerId = myPlayerId;
+        if (myPlayerId != -1)
+            findMyPlayer();
+        else
+            release_assert(mSpectator);
+
+        FASaveGame::GameSaver saver(mPacketPool.startPacket());
         saver.save(uint8_t(MessageType::AcknowledgeMapToServer));
-        auto data = stream.getData();
 
         EngineMain::get()->mInGame = true;
 
-        // does not take ownership of data
-        ENetPacket* packet = enet_packet_create(data.first, data.second, ENET_PACKET_FLAG_RELIABLE);
-        enet_peer_send(mServerPeer, RELIABLE_CHANNEL_ID, packet);
+        PacketPool::send(mServerPeer, RELIABLE_CHANNEL_ID, mPacketPool.finishPacket(ENET_PACKET_FLAG_RELIABLE));
     }
 
     void Client::receiveInputs(FASaveGame::GameLoader& loader)
     {
+        FAWorld::Tick currentTick = EngineMain::get()->mWorld->getCurrentTick();
+
+        // see Server::sendInputsToClients for the format
+        mInputDelay = loader.load<FAWorld::Tick>();
+
+        FAWorld::Tick tick = 0;
         while (loader.load<bool>())
         {
-            FAWorld::Tick tick = loader.load<FAWorld::Tick>();
-
-            auto& inputs = mInputs[tick];
+            tick += loader.load<FAWorld::Tick>();
             uint32_t size = loader.load<uint32_t>();
+            release_assert(size <= Server::MAX_INPUTS_PER_TICK);
+
+            // Most ticks arrive several times, and we have no use for ones we've already run. We might be in the middle of running
+            // currentTick - 1 (see waitForLevel()), so ticks that would overwrite its slot are dropped too. That shouldn't happen anyway,
+            // as the server disconnects clients long before they get that far behind.
+            if (tick < currentTick || tick >= currentTick - 1 + InputHistory::CAPACITY || mInputHistory.contains(tick))
+            {
+                FAWorld::PlayerInput unused;
+                for (uint32_t i = 0; i < size; i++)
+                    unused.load(loader);
+
+                continue;
+            }
+
+            std::vector<FAWorld::PlayerInput>& inputs = mInputHistory.startTick(tick);
             inputs.resize(size);
             for (uint32_t i = 0; i < size; i++)
                 inputs[i].load(loader);
         }
     }
 
+    void Client::findMyPlayer()
+    {
+        FAWorld::World& world = *EngineMain::get()->mWorld;
+
+        FAWorld::Player* myPlayer = static_cast<FAWorld::Player*>(world.getActorById(mMyPlayerId));
+        if (!myPlayer)
+            return;
+
+        world.addCurrentPlayer(myPlayer);
+        release_assert(myPlayer->getLevel()->isPassable(myPlayer->mMoveHandler.getCurrentPosition().current(), myPlayer));
+    }
+
+    void Client::receiveLevel(FASaveGame::GameLoader& loader)
+    {
+        int32_t levelIndex = loader.load<int32_t>();
+        WorldChunkReader levelReader(loader.load<std::string>());
+
+        EngineMain::get()->mWorld->loadPendingLevel(levelIndex, levelReader.getLoader());
+    }
+
     void Client::receiveVerifyPacket(FASaveGame::GameLoader& loader)
     {
         FAWorld::Tick tick = loader.load<FAWorld::Tick>();
-        mServerStatesForFullVerify[tick] = loader.load<std::string>();
+        WorldChecksums& checksums = mServerChecksums[tick];
+
+        uint32_t size = loader.load<uint32_t>();
+        for (uint32_t i = 0; i < size; i++)
+        {
+            int32_t levelIndex = loader.load<int32_t>();
+            checksums[levelIndex] = loader.load<uint64_t>();
+        }
+
+        compareChecksums();
     }
 
     void Client::sendClientUpdate()
     {
-        mLastLocalInputId++;
-        mLocalInputsBuffer[mLastLocalInputId] = mLocalInputHandler.getAndClearInputs();
-        FAWorld::PlayerInput::removeUnnecessaryInputs(mLocalInputsBuffer[mLastLocalInputId]);
+        std::vector<FAWorld::PlayerInput> localInputs = mLocalInputHandler.getAndClearInputs();
 
-        Serial::TextWriteStream stream;
+        // Spectators still send updates, so the server knows which ticks we have, but the server would ignore any inputs
+        if (!mSpectator)
+        {
+            mLastLocalInputId++;
+            mLocalInputsBuffer[mLastLocalInputId] = std::move(localInputs);
+            FAWorld::PlayerInput::removeUnnecessaryInputs(mLocalInputsBuffer[mLastLocalInputId]);
+        }
+
+        Serial::PackedWriteStream& stream = mPacketPool.startPacket();
         FASaveGame::GameSaver saver(stream);
 
         saver.save(uint8_t(MessageType::ClientUpdateToServer));
@@ -230,7 +397,7 @@ namespace Engine
         };
 
         // Send as many input sets as we can fit
-        size_t lastTickEndPosition = 0;
+        size_t lastTickEndPosition = stream.getCurrentSize();
         uint32_t inputSetNumber = mLastLocalInputId;
         for (; mLocalInputsBuffer.count(inputSetNumber); inputSetNumber--)
         {
@@ -251,10 +418,6 @@ namespace Engine
         stream.resize(lastTickEndPosition);
         saver.save(false); // there are no more inputs in this packet
 
-        auto data = stream.getData();
-
-        // does not take ownership of data
-        ENetPacket* packet = enet_packet_create(data.first, data.second, ENET_PACKET_FLAG_UNSEQUENCED);
-        enet_peer_send(mServerPeer, CLIENT_TO_SERVER_CHANNEL_ID, packet);
+        PacketPool::send(mServerPeer, CLIENT_TO_SERVER_CHANNEL_ID, mPacketPool.finishPacket(ENET_PACKET_FLAG_UNSEQUENCED));
     }
 }
@@ -1,5 +1,9 @@
 #pragma once
+#include "inputhistory.h"
 #include "multiplayerinterface.h"
+#include "netcommon.h"
+#include "packetpool.h"
+#include <chrono>
 #include <enet/enet.h>
 #include <set>
 
@@ -15,38 +19,67 @@ namespace Engine
     class Client : public MultiplayerInterface
     {
     public:
-        Client(LocalInputHandler& localInputHandler, const std::string& serverAddress);
+        // Spectators get the world and everyone's inputs, but have no player of their own, see MultiplayerInterface::ConnectType
+        Client(LocalInputHandler& localInputHandler, const std::string& serverAddress, bool spectator = false);
         virtual ~Client() override;
 
-        virtual std::optional<std::vector<FAWorld::PlayerInput>> getAndClearInputs(FAWorld::Tick tick) override;
+        virtual const std::vector<FAWorld::PlayerInput>* getInputs(FAWorld::Tick tick) override;
         virtual void update() override;
         virtual void verify(FAWorld::Tick tick) override;
         virtual bool isServer() const override { return false; }
         virtual bool isMultiplayer() const override { return true; }
         virtual bool isPlayerRegistered(uint32_t peerId) const override;
         virtual void registerNewPlayer(FAWorld::Player*, uint32_t peerId) override;
+        virtual void waitForLevel(int32_t levelIndex) override;
+        virtual bool isCatchingUp() const override { return mCatchingUp; }
 
         bool isConnected() { return mConnected; }
+        bool isSpectator() const { return mSpectator; }
         bool didConnectionFail() { return mConnectionFailed; }
 
     private:
+        void handleEvent(const ENetEvent& event);
         void processServerPacket(const ENetEvent& event);
         void receiveMap(FASaveGame::GameLoader& loader);
+        void receiveLevel(FASaveGame::GameLoader& loader);
         void receiveInputs(FASaveGame::GameLoader& loader);
         void receiveVerifyPacket(FASaveGame::GameLoader& loader);
+        void compareChecksums();
+        [[noreturn]] void onDesync(FAWorld::Tick tick, int32_t levelIndex);
         void sendClientUpdate();
+        void findMyPlayer();
 
         std::set<uint32_t> mRegisteredClientIds;
+        bool mSpectator = false;
+
+        // The server's snapshot can be from before we joined, in which case our player only appears when we replay the tick we joined on
+        int32_t mMyPlayerId = -1;
+        // The server only sends checksums from the tick it sent us the map on, so there's no point calculating our own before that
+        FAWorld::Tick mFirstVerifiedTick = 0;
 
         FAWorld::Tick mLastTickISentInputsOn = 0;
         LocalInputHandler& mLocalInputHandler;
         uint32_t mLastLocalInputId = 0;
         std::map<uint32_t, std::vector<FAWorld::PlayerInput>> mLocalInputsBuffer;
 
-        std::unordered_map<FAWorld::Tick, std::vector<FAWorld::PlayerInput>> mInputs;
+        // Inputs received from the server, for the ticks we haven't run yet (and some we have)
+        InputHistory mInputHistory;
+
+        // How far ahead the server schedules inputs, as of the last inputs packet, see Server::processInputs()
+        FAWorld::Tick mInputDelay = 0;
+        FAWorld::Tick mTicksToRunThisFrame = 0;
+
+        // When we have a lot of ticks to run, we only run as many as fit in a frame, and skip the wait for the next one, see getInputs()
+        static constexpr std::chrono::milliseconds CATCH_UP_FRAME_TIME{1000 / FAWorld::World::ticksPerSecond};
+        std::chrono::steady_clock::time_point mCatchUpFrameEnd;
+        FAWorld::Tick mTicksRunThisFrame = 0;
+        bool mCatchingUp = false;
+
+        // Checksums are compared as soon as we have both our own and the server's for a tick, so verification never holds up the game
+        std::map<FAWorld::Tick, WorldChecksums> mLocalChecksums;
+        std::map<FAWorld::Tick, WorldChecksums> mServerChecksums;
 
-        bool mDoFullVerify = false;
-        std::unordered_map<FAWorld::Tick, std::string> mServerStatesForFullVerify;
+        PacketPool mPacketPool;
 
         ENetHost* mHost = nullptr;
         ENetPeer* mServerPeer = nullptr;
@@ -55,6 +88,6 @@ namespace Engine
         bool mConnected = false;
         bool mConnectionFailed = false;
 
-        static constexpr size_t MAX_CLIENT_UPDATE_PACKET_SIZE = 500;
+        static constexpr size_t MAX_CLIENT_UPDATE_PACKET_SIZE = 250;
     };
 }
@@ -0,0 +1,28 @@
+#include "inputdelay.h"
+#include <algorithm>
+
+namespace Engine
+{
+    FAWorld::Tick InputDelay::ticksNeeded(uint32_t roundTripTime, uint32_t roundTripTimeVariance)
+    {
+        // Two variances covers nearly all packets, and we round up, as a tick late is a stall
+        uint64_t milliseconds = roundTripTime / 2 + roundTripTimeVariance * 2;
+        return FAWorld::Tick((milliseconds * FAWorld::World::ticksPerSecond + 999) / 1000);
+    }
+
+    void InputDelay::update(FAWorld::Tick needed)
+    {
+        needed = std::clamp(needed, FAWorld::Tick(0), MAX_TICKS);
+
+        if (needed >= mTicks)
+        {
+            mTicks = needed;
+            mTicksWithLessNeeded = 0;
+        }
+        else if (++mTicksWithLessNeeded >= DECREASE_INTERVAL)
+        {
+            mTicks--;
+            mTicksWithLessNeeded = 0;
+        }
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include "../../faworld/world.h"
+#include <cstdint>
+
+namespace Engine
+{
+    // How many ticks ahead of its own simulation the server schedules the inputs it receives. Clients need the inputs for a tick before
+    // they can run it, so with no delay they are always a one-way trip behind the server, and stutter whenever a packet is late.
+    // Scheduling inputs far enough ahead to cover the slowest client's one-way trip, plus a margin for jitter, lets everyone run in step,
+    // but every player (the host included) waits that long to see their own inputs happen, so we want it as small as we can get away with.
+    // The delay goes up as soon as it's needed, but only comes down slowly, so one delayed packet doesn't make it bounce around.
+    class InputDelay
+    {
+    public:
+        // Past this, a slow client only stalls itself, rather than adding lag for everyone
+        static constexpr FAWorld::Tick MAX_TICKS = 12;
+        static constexpr FAWorld::Tick DECREASE_INTERVAL = FAWorld::World::ticksPerSecond / 2;
+
+        // Ticks needed to cover a one-way trip for a peer, from ENet's round trip time statistics, in milliseconds
+        static FAWorld::Tick ticksNeeded(uint32_t roundTripTime, uint32_t roundTripTimeVariance);
+
+        // Called once per tick, with the largest ticksNeeded() of all peers
+        void update(FAWorld::Tick needed);
+        FAWorld::Tick get() const { return mTicks; }
+
+    private:
+        FAWorld::Tick mTicks = 0;
+        FAWorld::Tick mTicksWithLessNeeded = 0;
+    };
+}
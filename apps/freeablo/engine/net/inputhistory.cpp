@@ -0,0 +1,28 @@
+#include "inputhistory.h"
+#include <misc/assert.h>
+
+namespace Engine
+{
+    InputHistory::InputHistory(size_t maxInputsPerTick) : mSlots(size_t(CAPACITY))
+    {
+        for (Slot& slot : mSlots)
+            slot.inputs.reserve(maxInputsPerTick);
+    }
+
+    const std::vector<FAWorld::PlayerInput>& InputHistory::get(FAWorld::Tick tick) const
+    {
+        release_assert(contains(tick));
+        return slot(tick).inputs;
+    }
+
+    std::vector<FAWorld::PlayerInput>& InputHistory::startTick(FAWorld::Tick tick)
+    {
+        release_assert(tick >= 0);
+
+        Slot& slot = mSlots[size_t(tick % CAPACITY)];
+        slot.tick = tick;
+        slot.inputs.clear();
+
+        return slot.inputs;
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include "../../faworld/playerinput.h"
+#include "../../faworld/world.h"
+#include <vector>
+
+namespace Engine
+{
+    // The inputs for the most recent CAPACITY ticks, in a ring buffer indexed by tick modulo CAPACITY.
+    // Every slot has room for maxInputsPerTick inputs allocated up front, so storing a tick never allocates,
+    // and the memory used doesn't depend on how far behind anyone is.
+    class InputHistory
+    {
+    public:
+        static constexpr FAWorld::Tick CAPACITY = 2048;
+
+        explicit InputHistory(size_t maxInputsPerTick);
+
+        // False if the tick was never stored, or has been overwritten by a newer one
+        bool contains(FAWorld::Tick tick) const { return tick >= 0 && slot(tick).tick == tick; }
+        const std::vector<FAWorld::PlayerInput>& get(FAWorld::Tick tick) const;
+
+        // Claims the slot for tick, and returns its (emptied) list of inputs to be filled in
+        std::vector<FAWorld::PlayerInput>& startTick(FAWorld::Tick tick);
+
+    private:
+        struct Slot
+        {
+            FAWorld::Tick tick = -1;
+            std::vector<FAWorld::PlayerInput> inputs;
+        };
+
+        const Slot& slot(FAWorld::Tick tick) const { return mSlots[size_t(tick % CAPACITY)]; }
+
+        std::vector<Slot> mSlots;
+    };
+}
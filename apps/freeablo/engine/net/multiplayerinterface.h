@@ -2,7 +2,6 @@
 #include "../../faworld/world.h"
 #include <cstdint>
 #include <fa_nuklear.h>
-#include <optional>
 #include <vector>
 
 namespace FAWorld
@@ -18,7 +17,9 @@ namespace Engine
     public:
         virtual ~MultiplayerInterface() = default;
 
-        virtual std::optional<std::vector<FAWorld::PlayerInput>> getAndClearInputs(FAWorld::Tick tick) = 0;
+        // Returns the inputs to run the given tick with, or nullptr if we don't have them yet.
+        // The list is owned by the implementation, and is only valid until the next call to update().
+        virtual const std::vector<FAWorld::PlayerInput>* getInputs(FAWorld::Tick tick) = 0;
         virtual void update() = 0;
         virtual void verify(FAWorld::Tick tick) = 0;
         virtual bool isServer() const = 0;
@@ -27,6 +28,14 @@ namespace Engine
         virtual void registerNewPlayer(FAWorld::Player* player, uint32_t peerId) = 0;
         virtual void doMultiplayerGui(nk_context*){};
 
+        // Called by the world when the simulation needs a level that is still being sent to us, see FAWorld::World::addPendingLevel().
+        // Should not return until the level has been loaded.
+        virtual void waitForLevel(int32_t) {}
+
+        // True when we're behind, and getInputs() stopped handing out ticks only to give the rest of the frame a chance to run.
+        // The game loop should then start the next frame straight away, rather than waiting for the next tick.
+        virtual bool isCatchingUp() const { return false; }
+
         enum
         {
             RELIABLE_CHANNEL_ID = 10,
@@ -42,10 +51,18 @@ namespace Engine
             MapToClient,
             InputsToClient,
             VerifyToClient,
+            LevelToClient,
 
             // client-to-server
             AcknowledgeMapToServer,
             ClientUpdateToServer
         };
+
+        // Sent as the data of the connect request, see enet_host_connect()
+        enum class ConnectType : uint32_t
+        {
+            Player,
+            Spectator ///< Gets the world and all the inputs, but has no player, and can't send inputs of its own
+        };
     };
 }
@@ -0,0 +1,44 @@
+#include "netcommon.h"
+#include "../../faworld/gamelevel.h"
+#include "../../faworld/player.h"
+#include "../../faworld/world.h"
+
+namespace Engine
+{
+    WorldChecksums calculateWorldChecksums(FAWorld::World& world)
+    {
+        WorldChecksums checksums;
+        checksums[GLOBALS_CHECKSUM_INDEX] = world.getGlobalsChecksum();
+
+        for (FAWorld::Player* player : world.getPlayers())
+        {
+            const FAWorld::GameLevel* level = player->getLevel();
+
+            if (level && !checksums.count(level->getLevelIndex()))
+                checksums[level->getLevelIndex()] = level->getChecksum();
+        }
+
+        return checksums;
+    }
+
+    WorldChunkWriter::WorldChunkWriter(const std::function<void(FASaveGame::GameSaver&)>& saveFunction)
+    {
+        FASaveGame::GameSaver saver(mZlibStream);
+        saveFunction(saver);
+    }
+
+    std::string WorldChunkWriter::getCompressedData()
+    {
+        std::pair<uint8_t*, size_t> data = mZlibStream.getData();
+        return std::string(reinterpret_cast<const char*>(data.first), data.second);
+    }
+
+    WorldChunkReader::WorldChunkReader(std::string compressedData)
+        : mCompressedData(std::move(compressedData)),
+          mStream(reinterpret_cast<const uint8_t*>(mCompressedData.data()), mCompressedData.size(), [](const uint8_t* data, size_t size) {
+              return std::make_unique<Serial::BinaryReadStream>(data, size);
+          }),
+          mLoader(mStream)
+    {
+    }
+}
@@ -1,6 +1,55 @@
 #pragma once
+#include "../../fasavegame/gameloader.h"
+#include <cstdint>
 #include <enet/enet.h>
+#include <functional>
+#include <map>
+#include <serial/binarystream.h>
+#include <serial/zlibstream.h>
+#include <string>
+
+namespace FAWorld
+{
+    class World;
+}
 
 namespace Engine
 {
+    // Checksums of the parts of the world that are being simulated, keyed by level index.
+    // The world globals (rng state, tick counter etc.) are stored under GLOBALS_CHECKSUM_INDEX.
+    // Server and clients calculate these at the start of each tick and compare them to detect desyncs.
+    typedef std::map<int32_t, uint64_t> WorldChecksums;
+
+    static constexpr int32_t GLOBALS_CHECKSUM_INDEX = -1;
+
+    // Only levels with players on them are updated, so those are the only ones that can desync
+    WorldChecksums calculateWorldChecksums(FAWorld::World& world);
+
+    // Part of the world (the globals, or a single level) compressed on its own, so a joining client can load it independently of the rest.
+    // The data is serialised in the constructor, but only compressed when it is first needed, so the server can snapshot
+    // every level at once, but spread the expensive part over the ticks it spends sending them.
+    class WorldChunkWriter
+    {
+    public:
+        explicit WorldChunkWriter(const std::function<void(FASaveGame::GameSaver&)>& saveFunction);
+
+        std::string getCompressedData();
+
+    private:
+        Serial::BinaryWriteStream mStream;
+        Serial::ZlibWriteStream mZlibStream{mStream, true};
+    };
+
+    class WorldChunkReader
+    {
+    public:
+        explicit WorldChunkReader(std::string compressedData);
+
+        FASaveGame::GameLoader& getLoader() { return mLoader; }
+
+    private:
+        std::string mCompressedData;
+        Serial::ZlibReadStream mStream;
+        FASaveGame::GameLoader mLoader;
+    };
 }
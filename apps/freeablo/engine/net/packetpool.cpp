@@ -0,0 +1,58 @@
+#include "packetpool.h"
+#include <misc/assert.h>
+
+namespace Engine
+{
+    PacketPool::~PacketPool() { release_assert(mBuffersInUse == 0); }
+
+    Serial::PackedWriteStream& PacketPool::startPacket()
+    {
+        if (!mCurrentBuffer)
+        {
+            if (mFreeBuffers.empty())
+            {
+                mCurrentBuffer = std::make_unique<Buffer>();
+                mCurrentBuffer->pool = this;
+            }
+            else
+            {
+                mCurrentBuffer = std::move(mFreeBuffers.back());
+                mFreeBuffers.pop_back();
+            }
+        }
+
+        // resize doesn't give back the capacity, so after a few packets this never allocates
+        mCurrentBuffer->stream.resize(0);
+        return mCurrentBuffer->stream;
+    }
+
+    ENetPacket* PacketPool::finishPacket(enet_uint32 flags)
+    {
+        release_assert(mCurrentBuffer);
+
+        std::pair<uint8_t*, size_t> data = mCurrentBuffer->stream.getData();
+        ENetPacket* packet = enet_packet_create(data.first, data.second, flags | ENET_PACKET_FLAG_NO_ALLOCATE);
+        release_assert(packet);
+
+        packet->userData = mCurrentBuffer.release();
+        packet->freeCallback = &PacketPool::onPacketDestroyed;
+        mBuffersInUse++;
+
+        return packet;
+    }
+
+    void PacketPool::send(ENetPeer* peer, enet_uint8 channelId, ENetPacket* packet)
+    {
+        if (enet_peer_send(peer, channelId, packet) != 0 && packet->referenceCount == 0)
+            enet_packet_destroy(packet);
+    }
+
+    void ENET_CALLBACK PacketPool::onPacketDestroyed(ENetPacket* packet)
+    {
+        std::unique_ptr<Buffer> buffer(static_cast<Buffer*>(packet->userData));
+        PacketPool& pool = *buffer->pool;
+
+        pool.mBuffersInUse--;
+        pool.mFreeBuffers.push_back(std::move(buffer));
+    }
+}
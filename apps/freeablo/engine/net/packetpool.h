@@ -0,0 +1,46 @@
+#pragma once
+#include <enet/enet.h>
+#include <memory>
+#include <serial/packedstream.h>
+#include <vector>
+
+namespace Engine
+{
+    // Reusable buffers for the packets we send every tick. Normally ENet copies the data of every packet into a fresh allocation.
+    // Packets from here are written straight into a pooled buffer, which ENet sends from directly (ENET_PACKET_FLAG_NO_ALLOCATE),
+    // and which goes back into the pool when ENet destroys the packet. Once the pool has warmed up, only ENet's small packet header is allocated.
+    // Buffers keep the capacity of the largest packet written into them, so this is not meant for big one-off packets like the map.
+    // The pool must outlive every packet made from it, so destroy the ENetHost first.
+    class PacketPool
+    {
+    public:
+        PacketPool() = default;
+        ~PacketPool();
+
+        PacketPool(const PacketPool&) = delete;
+        PacketPool& operator=(const PacketPool&) = delete;
+
+        // Returns an empty stream to write the next packet into. If it's not turned into a packet with finishPacket(),
+        // the next call just returns the same stream again.
+        Serial::PackedWriteStream& startPacket();
+        ENetPacket* finishPacket(enet_uint32 flags);
+
+        // enet_peer_send(), but if the packet couldn't be queued it's destroyed, so its buffer isn't lost
+        static void send(ENetPeer* peer, enet_uint8 channelId, ENetPacket* packet);
+
+        size_t getBufferCount() const { return mFreeBuffers.size() + mBuffersInUse + (mCurrentBuffer ? 1 : 0); }
+
+    private:
+        struct Buffer
+        {
+            PacketPool* pool = nullptr;
+            Serial::PackedWriteStream stream;
+        };
+
+        static void ENET_CALLBACK onPacketDestroyed(ENetPacket* packet);
+
+        std::unique_ptr<Buffer> mCurrentBuffer;
+        std::vector<std::unique_ptr<Buffer>> mFreeBuffers;
+        size_t mBuffersInUse = 0;
+    };
+}
@@ -1,19 +1,26 @@
 #include "server.h"
 #include "../../fasavegame/gameloader.h"
+#include "../../faworld/gamelevel.h"
 #include "../../faworld/player.h"
 #include "../../faworld/world.h"
 #include "../enginemain.h"
 #include "../localinputhandler.h"
-#include <cstring>
+#include "netcommon.h"
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
 #include <misc/assert.h>
 #include <misc/misc.h>
-#include <serial/textstream.h>
+#include <serial/packedstream.h>
+#include <set>
 
 namespace Engine
 {
     const char* Server::SERVER_ADDRESS = "0.0.0.0";
 
+    // A peer that has just been sent a snapshot is this far behind, so it mustn't trip the check in sendInputsToClients()
+    static_assert(Server::MAX_SNAPSHOT_AGE + InputDelay::MAX_TICKS < InputHistory::CAPACITY / 2);
+
     Server::Server(FAWorld::World& world, LocalInputHandler& localInputHandler) : mWorld(world), mLocalInputHandler(localInputHandler)
     {
         if (0 != enet_initialize())
@@ -22,7 +29,7 @@ namespace Engine
         }
         mAddress.port = 6666;
         enet_address_set_host(&mAddress, SERVER_ADDRESS);
-        mHost = enet_host_create(&mAddress, 32, CHANNEL_ID_END, 0, 0);
+        mHost = enet_host_create(&mAddress, MAX_PLAYERS + MAX_SPECTATORS, CHANNEL_ID_END, 0, 0);
         mHost->checksum = enet_crc32;
     }
 
@@ -32,22 +39,13 @@ namespace Engine
         enet_deinitialize();
     }
 
-    std::optional<std::vector<FAWorld::PlayerInput>> Server::getAndClearInputs(FAWorld::Tick tick)
+    const std::vector<FAWorld::PlayerInput>* Server::getInputs(FAWorld::Tick tick)
     {
-        if (!mInputs.count(tick))
-            return std::nullopt;
-
-        /* for (const auto& pair : mPeers)
-         {
-             if (pair.second.hasMap && pair.second.lastTick + 10 < tick)
-                 return std::nullopt;
-         }*/
+        // Ticks past mLastTickToRun have been scheduled for the clients, but the server mustn't run them until it gets there in real time
+        if (tick > mLastTickToRun || tick > mLastSentTick || !mInputHistory.contains(tick))
+            return nullptr;
 
-        std::vector<FAWorld::PlayerInput> retval;
-        mInputs.at(tick).swap(retval);
-        mInputs.erase(tick);
-
-        return retval;
+        return &mInputHistory.get(tick);
     }
 
     void Server::update()
@@ -73,6 +71,7 @@ namespace Engine
                 case ENET_EVENT_TYPE_RECEIVE:
                 {
                     readPeerPacket(event);
+                    enet_packet_destroy(event.packet);
                     break;
                 }
                 case ENET_EVENT_TYPE_DISCONNECT:
@@ -98,43 +97,75 @@ namespace Engine
 
         FAWorld::PlayerInput::removeUnnecessaryInputs(mInputsBuffer);
 
-        // Don't allow more inputs in this tick than we can process in one packet.
-        size_t numberOfInputsToProcessThisTick =
-            std::min(mInputsBuffer.size(), (MAX_UPDATE_PACKET_SIZE - UPDATE_PACKET_START_PADDING) / FAWorld::PlayerInput::MAX_SERIALISED_INPUT_SIZE);
+        updateInputDelay();
 
-        // Split off the first n inputs into a separate vector
-        std::vector<FAWorld::PlayerInput> thisTickInputs;
+        // We can't have the server pulling directly from mInputsBuffer because then it would
+        // execute inputs at an earlier tick than the clients. So what we do here is essentially
+        // sending the buffer to all the clients, then "sending" it to the server as well, by means
+        // of the input history, see getInputs(). Inputs are scheduled mInputDelay ticks ahead, so they reach the clients in time to run them.
+        // When the delay goes up, the ticks skipped over get no inputs, and when it goes down, we stop scheduling until the world catches up.
+        mLastSentTick = std::max(mLastSentTick, mWorld.getCurrentTick() - 1);
+        while (mLastSentTick < mWorld.getCurrentTick() + mInputDelay.get())
         {
-            thisTickInputs.reserve(numberOfInputsToProcessThisTick);
-            for (size_t i = 0; i < numberOfInputsToProcessThisTick; i++)
-                thisTickInputs.push_back(mInputsBuffer[i]);
+            mLastSentTick++;
 
+            // Don't allow more inputs in this tick than we can process in one packet.
+            size_t numberOfInputsToProcessThisTick = std::min(mInputsBuffer.size(), MAX_INPUTS_PER_TICK);
+
+            std::vector<FAWorld::PlayerInput>& tickInputs = mInputHistory.startTick(mLastSentTick);
+            tickInputs.assign(mInputsBuffer.begin(), mInputsBuffer.begin() + numberOfInputsToProcessThisTick);
             mInputsBuffer.erase(mInputsBuffer.begin(), mInputsBuffer.begin() + numberOfInputsToProcessThisTick);
         }
 
-        // We can't have the server pulling directly from mInputsBuffer because then it would
-        // execute inputs at an earlier tick than the clients. So what we do here is essentially
-        // sending the buffer to all the clients, then "sending" it to the server as well, by means
-        // of the mInputs map.
-        sendInputsToClients(thisTickInputs);
-        mInputs[mWorld.getCurrentTick()] = std::move(thisTickInputs);
+        mLastTickToRun = mWorld.getCurrentTick();
+
+        sendInputsToClients();
+    }
+
+    void Server::updateInputDelay()
+    {
+        // ENet's round trip times are kept up to date by the acks for the checksum packets we send reliably every tick.
+        // Spectators don't send inputs, so there's no point making the players wait for them.
+        FAWorld::Tick needed = 0;
+        for (const auto& pair : mPeers)
+        {
+            const Peer& peer = pair.second;
+            if (peer.hasMap && !peer.spectator && !peer.disconnecting)
+                needed = std::max(needed, InputDelay::ticksNeeded(peer.peer->roundTripTime, peer.peer->roundTripTimeVariance));
+        }
 
-        mLastSentTick = mWorld.getCurrentTick();
+        mInputDelay.update(needed);
     }
 
     void Server::onPeerConnect(const ENetEvent& event)
     {
         enet_peer_timeout(event.peer, 99999, 99999, 99999);
 
-        mPeers[mNextPeerId] = Peer(event.peer);
-        event.peer->data = reinterpret_cast<void*>(size_t(mNextPeerId));
+        bool spectator = ConnectType(event.data) == ConnectType::Spectator;
+        size_t sameTypePeers = std::count_if(mPeers.begin(), mPeers.end(), [&](const auto& pair) { return pair.second.spectator == spectator; });
+
+        if (sameTypePeers >= (spectator ? MAX_SPECTATORS : MAX_PLAYERS))
+        {
+            // We'll still get a disconnect event for this peer, and maybe some packets, which are ignored as it's not in mPeers
+            event.peer->data = nullptr;
+            enet_peer_disconnect(event.peer, 0);
+            return;
+        }
+
+        uint32_t peerId = mNextPeerId++;
+        mPeers[peerId] = Peer(event.peer);
+        mPeers[peerId].spectator = spectator;
+        event.peer->data = reinterpret_cast<void*>(size_t(peerId));
+
+        // Spectators have no player, so they are sent the map straight away, see handleMapSending()
+        if (spectator)
+            return;
 
         // We pass the player joining as a PlayerInput so that other clients will know about them connecting.
         // Later on, the game will create an FAWorld::Player object for the player, and inform us of this through registerNewPlayer().
         // Once that is done, we have an actor for the player, so we can send them the map, which we do by calling handleMapSending()
         // regularly from update(), which checks for peers that haven't been sent a map yet, but do have an actor (actorId != -1).
-        EngineMain::get()->getLocalInputHandler()->addInput(FAWorld::PlayerInput(FAWorld::PlayerInput::PlayerJoinedData{mNextPeerId}, -1));
-        mNextPeerId++;
+        EngineMain::get()->getLocalInputHandler()->addInput(FAWorld::PlayerInput(FAWorld::PlayerInput::PlayerJoinedData{peerId}, -1));
     }
 
     bool Server::isPlayerRegistered(uint32_t peerId) const { return mPeers.at(peerId).actorId != -1; }
@@ -151,30 +182,103 @@ namespace Engine
         // see onPeerConnect for an explanation of this
         for (auto& peer : mPeers)
         {
-            if (!peer.second.mapSent && peer.second.actorId != -1)
+            if (!peer.second.mapSent && (peer.second.actorId != -1 || peer.second.spectator))
             {
                 sendMapToPeer(peer.second);
                 peer.second.mapSent = true;
             }
+            else if (peer.second.mapSent && !peer.second.levelsToSend.empty())
+            {
+                sendNextLevelToPeer(peer.second);
+            }
         }
     }
 
     void Server::onPeerDisconnect(const ENetEvent& event)
     {
-        uint32_t peerId = uint32_t(size_t(event.peer->data));
-        EngineMain::get()->getLocalInputHandler()->addInput(FAWorld::PlayerInput(FAWorld::PlayerInput::PlayerLeftData{}, mPeers.at(peerId).actorId));
-        mPeers.erase(peerId);
+        auto it = mPeers.find(uint32_t(size_t(event.peer->data)));
+        if (it == mPeers.end())
+            return;
+
+        if (!it->second.spectator)
+            EngineMain::get()->getLocalInputHandler()->addInput(FAWorld::PlayerInput(FAWorld::PlayerInput::PlayerLeftData{}, it->second.actorId));
+
+        mPeers.erase(it);
+    }
+
+    const Server::WorldSnapshot& Server::getWorldSnapshot()
+    {
+        if (mWorldSnapshot && mWorld.getCurrentTick() - mWorldSnapshot->tick <= MAX_SNAPSHOT_AGE)
+            return *mWorldSnapshot;
+
+        mWorldSnapshot = std::make_unique<WorldSnapshot>();
+        mWorldSnapshot->tick = mWorld.getCurrentTick();
+        mWorldSnapshot->globals = WorldChunkWriter([&](FASaveGame::GameSaver& chunkSaver) { mWorld.saveGlobals(chunkSaver); }).getCompressedData();
+
+        std::set<int32_t> levelsWithPlayers;
+        for (FAWorld::Player* player : mWorld.getPlayers())
+        {
+            if (player->getLevel())
+                levelsWithPlayers.insert(player->getLevel()->getLevelIndex());
+        }
+
+        for (const auto& pair : mWorld.getLevels())
+        {
+            int32_t levelIndex = pair.first;
+            auto saveLevel = [&](FASaveGame::GameSaver& chunkSaver) { mWorld.saveLevel(chunkSaver, levelIndex); };
+
+            if (pair.second == nullptr || levelsWithPlayers.count(levelIndex))
+                mWorldSnapshot->levelsInMapPacket.emplace_back(levelIndex, WorldChunkWriter(saveLevel).getCompressedData());
+            else
+                mWorldSnapshot->levelsSentLater.emplace_back(levelIndex, std::make_shared<WorldChunkWriter>(saveLevel));
+        }
+
+        return *mWorldSnapshot;
     }
 
     void Server::sendMapToPeer(Peer& peer)
     {
-        Serial::TextWriteStream stream;
+        // The client needs the levels that players are on before it can start simulating, so those go in this packet,
+        // along with ungenerated levels, as they're only a flag. The rest are sent one per tick afterwards,
+        // nearest to the joining player's level first. Each level is compressed separately, so the client can load them as they arrive.
+        // The snapshot can be a few seconds old, in which case the client replays the inputs since then to catch up with us.
+        // Levels without players aren't simulated, so the ones sent later are still valid if a player has moved onto them since.
+        const WorldSnapshot& snapshot = getWorldSnapshot();
+
+        // Spectators start out watching the first player, see Client::update()
+        int32_t spawnLevelIndex = 0;
+        if (!peer.spectator)
+            spawnLevelIndex = mWorld.getActorById(peer.actorId)->getLevel()->getLevelIndex();
+        else if (!mWorld.getPlayers().empty() && mWorld.getPlayers().front()->getLevel())
+            spawnLevelIndex = mWorld.getPlayers().front()->getLevel()->getLevelIndex();
+
+        std::vector<std::pair<int32_t, std::shared_ptr<WorldChunkWriter>>> levelsSentLater = snapshot.levelsSentLater;
+        std::stable_sort(levelsSentLater.begin(), levelsSentLater.end(), [&](const auto& a, const auto& b) {
+            return std::abs(a.first - spawnLevelIndex) < std::abs(b.first - spawnLevelIndex);
+        });
+
+        Serial::PackedWriteStream stream;
         FASaveGame::GameSaver saver(stream);
 
         saver.save(uint8_t(MessageType::MapToClient));
-        saver.save(mDoFullVerify);
         saver.save(peer.actorId);
-        mWorld.save(saver);
+        saver.save(snapshot.tick);
+        saver.save(mWorld.getCurrentTick());
+        saver.save(snapshot.globals);
+
+        saver.save(uint32_t(snapshot.levelsInMapPacket.size()));
+        for (const auto& level : snapshot.levelsInMapPacket)
+        {
+            saver.save(level.first);
+            saver.save(level.second);
+        }
+
+        saver.save(uint32_t(levelsSentLater.size()));
+        for (auto& level : levelsSentLater)
+        {
+            saver.save(level.first);
+            peer.levelsToSend.push_back(std::move(level));
+        }
 
         auto data = stream.getData();
 
@@ -182,12 +286,35 @@ namespace Engine
         ENetPacket* packet = enet_packet_create(data.first, data.second, ENET_PACKET_FLAG_RELIABLE);
         enet_peer_send(peer.peer, RELIABLE_CHANNEL_ID, packet);
 
-        peer.lastTick = mWorld.getCurrentTick() - 1;
+        peer.lastTick = std::max(snapshot.tick - 1, FAWorld::Tick(0));
+    }
+
+    void Server::sendNextLevelToPeer(Peer& peer)
+    {
+        Serial::PackedWriteStream stream;
+        FASaveGame::GameSaver saver(stream);
+
+        saver.save(uint8_t(MessageType::LevelToClient));
+        saver.save(peer.levelsToSend.front().first);
+        saver.save(peer.levelsToSend.front().second->getCompressedData());
+
+        peer.levelsToSend.pop_front();
+
+        auto data = stream.getData();
+
+        // does not take ownership of data
+        ENetPacket* packet = enet_packet_create(data.first, data.second, ENET_PACKET_FLAG_RELIABLE);
+        enet_peer_send(peer.peer, RELIABLE_CHANNEL_ID, packet);
     }
 
     void Server::readPeerPacket(const ENetEvent& event)
     {
-        Serial::TextReadStream stream(std::string((const char*)event.packet->data, event.packet->dataLength));
+        // Peers we turned away in onPeerConnect() can still get a few packets in before they disconnect
+        auto it = mPeers.find(uint32_t(size_t(event.peer->data)));
+        if (it == mPeers.end())
+            return;
+
+        Serial::PackedReadStream stream(event.packet->data, event.packet->dataLength);
         FASaveGame::GameLoader loader(stream);
 
         MessageType type = MessageType(loader.load<uint8_t>());
@@ -196,195 +323,254 @@ namespace Engine
         {
             case MessageType::AcknowledgeMapToServer:
             {
-                mPeers.at(uint32_t(size_t(event.peer->data))).hasMap = true;
+                it->second.hasMap = true;
                 return;
             }
 
             case MessageType::ClientUpdateToServer:
             {
-                receiveClientUpdate(loader, mPeers.at(uint32_t(size_t(event.peer->data))));
+                receiveClientUpdate(loader, it->second);
                 return;
             }
 
             case MessageType::InputsToClient:
             case MessageType::MapToClient:
             case MessageType::VerifyToClient:
+            case MessageType::LevelToClient:
                 invalid_enum(MessageType, type);
         }
 
         invalid_enum(MessageType, type);
     }
 
-    void Server::sendInputsToClients(std::vector<FAWorld::PlayerInput>& inputs)
+    void Server::sendInputsToClients()
     {
         // The basic approach of this function is to send a fized-size packet each tick, and just fill it with as many ticks worth of
         // inputs as we can fit. We ensure that these are chosen well, and that every tick is guaranteed to be received eventually by every client.
 
-        mOldInputs[mWorld.getCurrentTick()] = inputs;
+        // Inputs are scheduled ahead of the world, see processInputs(), so this is the newest tick we can send
+        FAWorld::Tick newestTick = mLastSentTick;
+        bool evenTick = mWorld.getCurrentTick() % 2 == 0;
 
-        FAWorld::Tick oldestNeededTick = std::numeric_limits<FAWorld::Tick>::max();
+        // On odd ticks, where we only send the most recent inputs, all spectators get the same packet, going back as far as
+        // the spectator that is furthest behind. That way, a crowd of spectators costs little more than one.
+        ENetPacket* spectatorPacket = nullptr;
+        FAWorld::Tick oldestSpectatorTick = newestTick;
+        for (const auto& pair : mPeers)
+        {
+            if (pair.second.spectator && pair.second.hasMap && !pair.second.disconnecting)
+                oldestSpectatorTick = std::min(oldestSpectatorTick, pair.second.lastTick);
+        }
 
         for (auto& pair : mPeers)
         {
             Peer& peer = pair.second;
 
-            if (!peer.hasMap)
+            if (!peer.hasMap || peer.disconnecting)
                 continue;
 
-            bool firstInPacket = true;
+            // The history only goes back so far, if a client falls further behind than that, it can never catch up.
+            // We give up at half of it, so the client always has room for everything we send, see Client::receiveInputs().
+            if (newestTick - peer.lastTick >= InputHistory::CAPACITY / 2)
+            {
+                std::cerr << "Player " << peer.actorId << " is too far behind to catch up, disconnecting them" << std::endl;
+                enet_peer_disconnect(peer.peer, 0);
+                peer.disconnecting = true;
+                continue;
+            }
 
-            auto fillPacket = [this, &firstInPacket](FAWorld::Tick& currentlyProcessingTick) -> ENetPacket* {
-                Serial::TextWriteStream stream;
-                FASaveGame::GameSaver saver(stream);
+            peer.bytesSentLastTick = 0;
 
-                saver.save(uint8_t(MessageType::InputsToClient));
+            if (peer.spectator && !evenTick)
+            {
+                if (!spectatorPacket)
+                {
+                    FAWorld::Tick unused = 0;
+                    spectatorPacket = fillInputsPacket(unused, oldestSpectatorTick, newestTick);
+                }
 
-                size_t lastTickEndPosition = 0;
+                if (spectatorPacket)
+                {
+                    peer.bytesSentLastTick += spectatorPacket->dataLength;
+                    enet_peer_send(peer.peer, SERVER_TO_CLIENT_CHANNEL_ID, spectatorPacket);
+                }
 
-                auto addTick = [&](FAWorld::Tick tick) {
-                    saver.save(true); // Is there another tick in this packet?
-                    saver.save(tick);
-                    saver.save(uint32_t(mOldInputs[tick].size()));
+                continue;
+            }
 
-                    if (firstInPacket)
-                    {
-                        release_assert(stream.getCurrentSize() < UPDATE_PACKET_START_PADDING);
-                        firstInPacket = false;
-                    }
+            FAWorld::Tick currentlyProcessingTick = peer.lastSentTick;
 
-                    for (const auto& input : mOldInputs[tick])
-                        input.save(saver);
+            if (currentlyProcessingTick < peer.lastTick || currentlyProcessingTick >= newestTick - 5)
+                currentlyProcessingTick = peer.lastTick;
 
-                    if (stream.getCurrentSize() > MAX_UPDATE_PACKET_SIZE)
-                    {
-                        // This assert detects single ticks with too many inputs to fit in one packet.
-                        // This should not happen, as we should never allow more than
-                        // ((MAX_UPDATE_PACKET_SIZE - UPDATE_PACKET_START_PADDING) / PlayerInput::MAX_SERIALISED_INPUT_SIZE) inputs in one tick.
-                        // TODO: there is a few bits added to the packet before we start the inputs, we should account for them somehow.
-                        release_assert(lastTickEndPosition > 0);
-                        return false;
-                    }
+            if (ENetPacket* packet = fillInputsPacket(currentlyProcessingTick, peer.lastTick, newestTick))
+            {
+                peer.bytesSentLastTick += packet->dataLength;
+                PacketPool::send(peer.peer, SERVER_TO_CLIENT_CHANNEL_ID, packet);
 
-                    lastTickEndPosition = stream.getCurrentSize();
-                    return true;
-                };
+                peer.lastSentTick = currentlyProcessingTick;
+            }
+        }
 
-                // On even ticks, we cycle through old inputs, and on odd ticks we just send as many of the most recent ticks
-                // as we can fit. This provides a decent balance between definitely sending everything again if it's needed
-                // (because of packet loss/corruption), and always sending the most recent stuff.
-                if (mWorld.getCurrentTick() % 2 == 0)
-                {
-                    addTick(mWorld.getCurrentTick());
+        // ENet only destroys packets it has queued, so we have to clean up if none of the sends worked
+        if (spectatorPacket && spectatorPacket->referenceCount == 0)
+            enet_packet_destroy(spectatorPacket);
 
-                    while (currentlyProcessingTick < mWorld.getCurrentTick())
-                    {
-                        if (!addTick(currentlyProcessingTick))
-                            break;
+        if (mLastTickVerified < mWorld.getCurrentTick())
+        {
+            sendChecksumsToClients();
+            mLastTickVerified = mWorld.getCurrentTick();
+        }
+    }
 
-                        currentlyProcessingTick++;
-                    }
-                }
-                else
-                {
-                    FAWorld::Tick tick = mWorld.getCurrentTick();
-                    while (mOldInputs.count(tick) != 0)
-                    {
-                        if (!addTick(tick))
-                            break;
-
-                        tick--;
-                    }
-                }
+    ENetPacket* Server::fillInputsPacket(FAWorld::Tick& currentlyProcessingTick, FAWorld::Tick oldestTick, FAWorld::Tick newestTick)
+    {
+        Serial::PackedWriteStream& stream = mPacketPool.startPacket();
+        FASaveGame::GameSaver saver(stream);
 
-                if (lastTickEndPosition == 0)
-                    return nullptr;
+        saver.save(uint8_t(MessageType::InputsToClient));
+        saver.save(mInputDelay.get());
 
-                stream.resize(lastTickEndPosition);
-                saver.save(false); // There are no more ticks in this packet
+        size_t lastTickEndPosition = 0;
+        FAWorld::Tick previousTick = 0;
 
-                auto data = stream.getData();
-                ENetPacket* packet = enet_packet_create(nullptr, data.second, ENET_PACKET_FLAG_UNSEQUENCED);
-                memcpy(packet->data, data.first, data.second);
+        // Ticks are written as the difference from the previous one in the packet, as they're mostly consecutive, so that's one byte
+        auto addTick = [&](FAWorld::Tick tick) {
+            saver.save(true); // Is there another tick in this packet?
+            saver.save(tick - previousTick);
+            previousTick = tick;
+            const std::vector<FAWorld::PlayerInput>& inputs = mInputHistory.get(tick);
+            saver.save(uint32_t(inputs.size()));
 
-                return packet;
-            };
+            if (lastTickEndPosition == 0)
+                release_assert(stream.getCurrentSize() < UPDATE_PACKET_START_PADDING);
 
-            FAWorld::Tick currentlyProcessingTick = peer.lastSentTick;
+            for (const auto& input : inputs)
+                input.save(saver);
 
-            if (currentlyProcessingTick < peer.lastTick || currentlyProcessingTick >= mWorld.getCurrentTick() - 5)
-                currentlyProcessingTick = peer.lastTick;
+            if (stream.getCurrentSize() > MAX_UPDATE_PACKET_SIZE)
+            {
+                // This assert detects single ticks with too many inputs to fit in one packet.
+                // This should not happen, as we should never allow more than
+                // ((MAX_UPDATE_PACKET_SIZE - UPDATE_PACKET_START_PADDING) / PlayerInput::MAX_SERIALISED_INPUT_SIZE) inputs in one tick.
+                // TODO: there is a few bits added to the packet before we start the inputs, we should account for them somehow.
+                release_assert(lastTickEndPosition > 0);
+                return false;
+            }
 
-            oldestNeededTick = std::min(oldestNeededTick, peer.lastTick);
+            lastTickEndPosition = stream.getCurrentSize();
+            return true;
+        };
 
-            peer.bytesSentLastTick = 0;
+        // On even ticks, we cycle through old inputs, and on odd ticks we just send as many of the most recent ticks
+        // as we can fit. This provides a decent balance between definitely sending everything again if it's needed
+        // (because of packet loss/corruption), and always sending the most recent stuff.
+        if (mWorld.getCurrentTick() % 2 == 0)
+        {
+            addTick(newestTick);
 
-            if (ENetPacket* packet = fillPacket(currentlyProcessingTick))
+            while (currentlyProcessingTick < newestTick)
             {
-                peer.bytesSentLastTick += packet->dataLength;
-                enet_peer_send(peer.peer, SERVER_TO_CLIENT_CHANNEL_ID, packet);
+                if (!addTick(currentlyProcessingTick))
+                    break;
 
-                peer.lastSentTick = currentlyProcessingTick;
+                currentlyProcessingTick++;
             }
         }
-
-        // Remove no-longer needed old input lists
-        // Done as a manual loop, because apparently std::remove_if doesn't work on associative containers (yet)
-        for (auto it = mOldInputs.begin(); it != mOldInputs.end();)
+        else
         {
-            if (it->first < oldestNeededTick)
-                it = mOldInputs.erase(it);
-            else
-                ++it;
+            FAWorld::Tick tick = newestTick;
+            while (tick >= oldestTick && mInputHistory.contains(tick))
+            {
+                if (!addTick(tick))
+                    break;
+
+                tick--;
+            }
         }
 
-        if (mDoFullVerify && !mPeers.empty() && mLastTickVerified < mWorld.getCurrentTick())
+        if (lastTickEndPosition == 0)
+            return nullptr;
+
+        stream.resize(lastTickEndPosition);
+        saver.save(false); // There are no more ticks in this packet
+
+        return mPacketPool.finishPacket(ENET_PACKET_FLAG_UNSEQUENCED);
+    }
+
+    void Server::sendChecksumsToClients()
+    {
+        ENetPacket* packet = nullptr;
+
+        for (auto& pair : mPeers)
         {
-            Serial::TextWriteStream stream;
-            FASaveGame::GameSaver saver(stream);
+            Peer& peer = pair.second;
 
-            saver.save(uint8_t(MessageType::VerifyToClient));
-            saver.save(mWorld.getCurrentTick());
+            if (!peer.hasMap || peer.disconnecting)
+                continue;
 
-            // save world as a string
+            // Only calculated once we know someone needs them, and then shared between all peers
+            if (!packet)
             {
-                Serial::TextWriteStream worldStream;
-                FASaveGame::GameSaver worldSaver(worldStream);
-                mWorld.save(worldSaver);
-                auto worldData = worldStream.getData();
+                WorldChecksums checksums = calculateWorldChecksums(mWorld);
 
-                std::string strData((const char*)worldData.first, worldData.second);
-                saver.save(strData);
-            }
+                FASaveGame::GameSaver saver(mPacketPool.startPacket());
 
-            auto data = stream.getData();
-            ENetPacket* packet = enet_packet_create(data.first, data.second, ENET_PACKET_FLAG_RELIABLE);
-            enet_host_broadcast(mHost, RELIABLE_CHANNEL_ID, packet);
+                saver.save(uint8_t(MessageType::VerifyToClient));
+                saver.save(mWorld.getCurrentTick());
+                saver.save(uint32_t(checksums.size()));
 
-            mLastTickVerified = mWorld.getCurrentTick();
+                for (const auto& checksum : checksums)
+                {
+                    saver.save(checksum.first);
+                    saver.save(checksum.second);
+                }
+
+                packet = mPacketPool.finishPacket(ENET_PACKET_FLAG_RELIABLE);
+            }
+
+            peer.bytesSentLastTick += packet->dataLength;
+            enet_peer_send(peer.peer, RELIABLE_CHANNEL_ID, packet);
         }
+
+        // ENet only destroys packets it has queued, so we have to clean up if none of the sends worked
+        if (packet && packet->referenceCount == 0)
+            enet_packet_destroy(packet);
     }
 
     void Server::receiveClientUpdate(FASaveGame::GameLoader& loader, Peer& peer)
     {
         peer.lastTick = loader.load<FAWorld::Tick>();
 
-        std::map<uint32_t, std::vector<FAWorld::PlayerInput>> inputSetsInPacket;
+        // Spectators are read only, we only need to know how far they've got
+        if (peer.spectator)
+            return;
+
+        // The sets are parsed into scratch space that's kept between packets, so this doesn't allocate once it has warmed up
+        mReceivedInputSets.clear();
+        mReceivedInputs.clear();
         while (loader.load<bool>())
         {
-            auto& inputSet = inputSetsInPacket[loader.load<uint32_t>()];
+            ReceivedInputSet& inputSet = mReceivedInputSets.emplace_back();
+            inputSet.id = loader.load<uint32_t>();
+            inputSet.begin = mReceivedInputs.size();
 
             uint32_t size = loader.load<uint32_t>();
-            inputSet.resize(size);
             for (size_t i = 0; i < size; i++)
-                inputSet[i].load(loader);
+                mReceivedInputs.emplace_back().load(loader);
+
+            inputSet.end = mReceivedInputs.size();
         }
 
-        for (auto it = inputSetsInPacket.begin(); it != inputSetsInPacket.end(); ++it)
+        // Clients send their newest set first, but we need to apply them oldest first
+        std::sort(mReceivedInputSets.begin(), mReceivedInputSets.end(), [](const ReceivedInputSet& a, const ReceivedInputSet& b) { return a.id < b.id; });
+
+        for (const ReceivedInputSet& inputSet : mReceivedInputSets)
         {
-            if (it->first > peer.lastInputSetIdReceived)
+            if (inputSet.id > peer.lastInputSetIdReceived)
             {
-                mInputsBuffer.insert(mInputsBuffer.end(), it->second.begin(), it->second.end());
-                peer.lastInputSetIdReceived = it->first;
+                mInputsBuffer.insert(mInputsBuffer.end(), mReceivedInputs.begin() + inputSet.begin, mReceivedInputs.begin() + inputSet.end);
+                peer.lastInputSetIdReceived = inputSet.id;
             }
         }
     }
@@ -393,10 +579,14 @@ namespace Engine
     {
         if (nk_begin(ctx, "Players", nk_rect(0, 0, 600, 200), NK_WINDOW_TITLE | NK_WINDOW_MOVABLE | NK_WINDOW_SCALABLE | NK_WINDOW_MINIMIZABLE))
         {
-            nk_layout_row_dynamic(ctx, 30, 4);
+            nk_layout_row_dynamic(ctx, 30, 1);
+            nk_label(ctx, ("Input delay: " + std::to_string(mInputDelay.get()) + " ticks").c_str(), NK_TEXT_LEFT);
+
+            nk_layout_row_dynamic(ctx, 30, 5);
 
             nk_label(ctx, "Player ID", NK_TEXT_CENTERED);
             nk_label(ctx, "Ticks behind", NK_TEXT_CENTERED);
+            nk_label(ctx, "Round trip ms", NK_TEXT_CENTERED);
             nk_label(ctx, "Bytes/Tick", NK_TEXT_CENTERED);
             nk_label(ctx, "Bytes/Second", NK_TEXT_CENTERED);
 
@@ -404,16 +594,20 @@ namespace Engine
             {
                 const Peer& peer = pair.second;
 
-                nk_label(ctx, std::to_string(peer.actorId).c_str(), NK_TEXT_CENTERED);
+                // Spectators don't have an actor id, so the stats are kept by peer id
+                std::string statsKey = std::to_string(pair.first);
+                nk_label(ctx, peer.spectator ? "Spectator" : std::to_string(peer.actorId).c_str(), NK_TEXT_CENTERED);
 
-                double ticksBehind = mStatsAverager.getAverage(std::to_string(peer.actorId) + "_ticks_behind", mWorld.getCurrentTick() - peer.lastTick);
+                double ticksBehind = mStatsAverager.getAverage(statsKey + "_ticks_behind", mWorld.getCurrentTick() - peer.lastTick);
                 nk_label(ctx, std::to_string(ticksBehind).c_str(), NK_TEXT_RIGHT);
 
-                double bytesPerTick = mStatsAverager.getAverage(std::to_string(peer.actorId) + "_bytes_sent_per_tick", peer.bytesSentLastTick);
+                nk_label(ctx, (std::to_string(peer.peer->roundTripTime) + " +- " + std::to_string(peer.peer->roundTripTimeVariance)).c_str(), NK_TEXT_RIGHT);
+
+                double bytesPerTick = mStatsAverager.getAverage(statsKey + "_bytes_sent_per_tick", peer.bytesSentLastTick);
                 nk_label(ctx, std::to_string(bytesPerTick).c_str(), NK_TEXT_RIGHT);
 
-                double bytesPerSec = mStatsAverager.getAverage(std::to_string(peer.actorId) + "_bytes_sent_per_second",
-                                                               peer.bytesSentLastTick * FAWorld::World::getTicksInPeriod(FixedPoint(1)));
+                double bytesPerSec =
+                    mStatsAverager.getAverage(statsKey + "_bytes_sent_per_second", peer.bytesSentLastTick * FAWorld::World::getTicksInPeriod(FixedPoint(1)));
                 nk_label(ctx, Misc::numberToHumanFileSize(bytesPerSec).c_str(), NK_TEXT_RIGHT);
             }
         }
@@ -1,8 +1,13 @@
 #pragma once
+#include "inputdelay.h"
+#include "inputhistory.h"
 #include "multiplayerinterface.h"
+#include "netcommon.h"
+#include "packetpool.h"
 #include <enet/enet.h>
+#include <deque>
+#include <memory>
 #include <misc/averager.h>
-#include <unordered_map>
 
 namespace FAWorld
 {
@@ -16,10 +21,24 @@ namespace Engine
     class Server : public MultiplayerInterface
     {
     public:
+        // Packets are written with Serial::PackedWriteStream, where an input is usually around 6 bytes, and a tick with no inputs is 3
+        static constexpr size_t UPDATE_PACKET_START_PADDING = 50;
+        static constexpr size_t MAX_UPDATE_PACKET_SIZE = 500;
+
+        // We never put more inputs in one tick than will fit in a single packet
+        static constexpr size_t MAX_INPUTS_PER_TICK = (MAX_UPDATE_PACKET_SIZE - UPDATE_PACKET_START_PADDING) / FAWorld::PlayerInput::MAX_SERIALISED_INPUT_SIZE;
+
+        static constexpr size_t MAX_PLAYERS = 32;
+        static constexpr size_t MAX_SPECTATORS = 32;
+
+        // Joining peers can be sent a snapshot of the world up to this old, and catch up by replaying the inputs since, see Client::isCatchingUp().
+        // That way, peers that join around the same time share one snapshot, instead of each one stalling the server for a new one.
+        static constexpr FAWorld::Tick MAX_SNAPSHOT_AGE = FAWorld::World::ticksPerSecond * 5;
+
         Server(FAWorld::World& world, LocalInputHandler& localInputHandler);
         virtual ~Server();
 
-        virtual std::optional<std::vector<FAWorld::PlayerInput>> getAndClearInputs(FAWorld::Tick tick) override;
+        virtual const std::vector<FAWorld::PlayerInput>* getInputs(FAWorld::Tick tick) override;
         virtual void update() override;
         virtual void verify(FAWorld::Tick) override {}
         virtual bool isServer() const override { return true; }
@@ -35,8 +54,10 @@ namespace Engine
             explicit Peer(ENetPeer* peer) : peer(peer) {}
 
             ENetPeer* peer = nullptr;
+            bool spectator = false; ///< see MultiplayerInterface::ConnectType::Spectator
             bool hasMap = false;
             bool mapSent = false;
+            bool disconnecting = false; ///< we've asked ENet to disconnect them, and are waiting for the disconnect event
 
             FAWorld::Tick lastTick = 0;
             uint32_t lastInputSetIdReceived = 0;
@@ -44,21 +65,48 @@ namespace Engine
             int32_t actorId = -1;
             size_t bytesSentLastTick = 0;
             FAWorld::Tick lastSentTick = -1;
+
+            // Levels that weren't included in the map packet, in the order they will be sent, see sendMapToPeer()
+            std::deque<std::pair<int32_t, std::shared_ptr<WorldChunkWriter>>> levelsToSend;
+        };
+
+        // The world as it was on some recent tick, see MAX_SNAPSHOT_AGE
+        struct WorldSnapshot
+        {
+            FAWorld::Tick tick = 0;
+            std::string globals;
+
+            // Levels with players on them, and ungenerated ones, are compressed straight away, as they go in the map packet.
+            // The rest are shared by all the peers we send the snapshot to, and are compressed when first sent, see sendNextLevelToPeer().
+            std::vector<std::pair<int32_t, std::string>> levelsInMapPacket;
+            std::vector<std::pair<int32_t, std::shared_ptr<WorldChunkWriter>>> levelsSentLater;
         };
 
         void handleMapSending();
         void handleEvents();
         void processInputs();
+        void updateInputDelay();
         void onPeerConnect(const ENetEvent& event);
         void onPeerDisconnect(const ENetEvent& event);
+        const WorldSnapshot& getWorldSnapshot();
         void sendMapToPeer(Peer& peer);
+        void sendNextLevelToPeer(Peer& peer);
         void readPeerPacket(const ENetEvent& event);
-        void sendInputsToClients(std::vector<FAWorld::PlayerInput>& inputs);
+        void sendInputsToClients();
+        ENetPacket* fillInputsPacket(FAWorld::Tick& currentlyProcessingTick, FAWorld::Tick oldestTick, FAWorld::Tick newestTick);
+        void sendChecksumsToClients();
         void receiveClientUpdate(FASaveGame::GameLoader& loader, Peer& peer);
 
+        // An input set from a client update packet, as a range in mReceivedInputs
+        struct ReceivedInputSet
+        {
+            uint32_t id = 0;
+            size_t begin = 0;
+            size_t end = 0;
+        };
+
         static const char* SERVER_ADDRESS;
 
-        bool mDoFullVerify = false;
         FAWorld::Tick mLastTickVerified = -1;
 
         FAWorld::World& mWorld;
@@ -67,14 +115,25 @@ namespace Engine
         // This is where we accumulate inputs received from clients before we execute them
         std::vector<FAWorld::PlayerInput> mInputsBuffer;
 
-        // Inputs from old ticks that clients might not have yet
-        std::unordered_map<FAWorld::Tick, std::vector<FAWorld::PlayerInput>> mOldInputs;
-
-        // This is where we locally store inputs to be executed by the server.
-        // They are accumulated in mInputsBuffer, and eventually both sent to clients and moved into here.
-        std::unordered_map<FAWorld::Tick, std::vector<FAWorld::PlayerInput>> mInputs;
+        // The inputs we've decided on for each tick. They are accumulated in mInputsBuffer, then moved in here, and from here both executed by
+        // the server and sent to clients. Old ticks are kept for resending to clients that haven't acknowledged them yet.
+        InputHistory mInputHistory{MAX_INPUTS_PER_TICK};
 
+        // The newest tick we've decided the inputs for, usually mInputDelay ticks ahead of the world
         FAWorld::Tick mLastSentTick = -1;
+        InputDelay mInputDelay;
+
+        // The world's tick as of the last processInputs(), so we run one tick per update() however far ahead the inputs are scheduled
+        FAWorld::Tick mLastTickToRun = -1;
+
+        std::unique_ptr<WorldSnapshot> mWorldSnapshot;
+
+        // Scratch space for receiveClientUpdate()
+        std::vector<ReceivedInputSet> mReceivedInputSets;
+        std::vector<FAWorld::PlayerInput> mReceivedInputs;
+
+        // For the packets we send every tick. mHost is destroyed in our destructor, so this outlives all of them
+        PacketPool mPacketPool;
 
         ENetHost* mHost = nullptr;
         ENetAddress mAddress;
@@ -83,8 +142,5 @@ namespace Engine
         std::map<uint32_t, Peer> mPeers;
 
         Misc::Averager mStatsAverager;
-
-        static constexpr size_t UPDATE_PACKET_START_PADDING = 50;
-        static constexpr size_t MAX_UPDATE_PACKET_SIZE = 1000;
     };
 }
@@ -4,16 +4,25 @@
 #include <chrono>
 #include <input/inputmanager.h>
 #include <iostream>
+#include <misc/assert.h>
 
 namespace Engine
 {
     ThreadManager* ThreadManager::mThreadManager = nullptr;
     ThreadManager* ThreadManager::get() { return mThreadManager; }
 
-    ThreadManager::ThreadManager() : mQueue(100), mRenderState(nullptr), mAudioManager(50, 100) { mThreadManager = this; }
+    ThreadManager::ThreadManager(bool headless) : mQueue(100), mRenderState(nullptr), mHeadless(headless)
+    {
+        if (!headless)
+            mAudioManager = std::make_unique<FAAudio::AudioManager>(50, 100);
+
+        mThreadManager = this;
+    }
 
     void ThreadManager::run()
     {
+        release_assert(!mHeadless);
+
         const int MAXIMUM_DURATION_IN_MS = 1000;
         Input::InputManager* inputManager = Input::InputManager::get();
         FARender::Renderer* renderer = FARender::Renderer::get();
@@ -54,7 +63,7 @@ namespace Engine
 
     void ThreadManager::playMusic(const std::string& path)
     {
-        if (DebugSettings::DisableMusic)
+        if (DebugSettings::DisableMusic || mHeadless)
             return;
 
         Message message = {};
@@ -66,6 +75,9 @@ namespace Engine
 
     void ThreadManager::playSound(const std::string& path)
     {
+        if (mHeadless)
+            return;
+
         if (path.empty())
         {
             std::cerr << "Attempt to play invalid sound!" << std::endl;
@@ -81,15 +93,21 @@ namespace Engine
 
     void ThreadManager::stopSound()
     {
+        if (mHeadless)
+            return;
+
         Message message = {};
         message.type = ThreadState::STOP_SOUND;
         mQueue.push(message);
     }
 
-    bool ThreadManager::isPlayingSound() const { return mAudioManager.isPlayingSound(); }
+    bool ThreadManager::isPlayingSound() const { return !mHeadless && mAudioManager->isPlayingSound(); }
 
     void ThreadManager::sendRenderState(FARender::RenderState* state)
     {
+        if (mHeadless)
+            return;
+
         Message message = {};
         message.type = ThreadState::RENDER_STATE;
         message.data.renderState = state;
@@ -103,21 +121,21 @@ namespace Engine
         {
             case ThreadState::PLAY_MUSIC:
             {
-                mAudioManager.playMusic(*message.data.musicPath);
+                mAudioManager->playMusic(*message.data.musicPath);
                 delete message.data.musicPath;
                 break;
             }
 
             case ThreadState::PLAY_SOUND:
             {
-                mAudioManager.playSound(*message.data.soundPath);
+                mAudioManager->playSound(*message.data.soundPath);
                 delete message.data.soundPath;
                 break;
             }
 
             case ThreadState::STOP_SOUND:
             {
-                mAudioManager.stopSound();
+                mAudioManager->stopSound();
                 break;
             }
 
@@ -1,5 +1,6 @@
 #pragma once
 #include "../faaudio/audiomanager.h"
+#include <memory>
 #include <string>
 
 // clang-format off
@@ -40,7 +41,8 @@ namespace Engine
     {
     public:
         static ThreadManager* get();
-        ThreadManager();
+        // A headless ThreadManager has no audio and is never run, so messages that would go to the render thread are just dropped
+        explicit ThreadManager(bool headless = false);
         void run();
         void playMusic(const std::string& path);
         void playSound(const std::string& path);
@@ -54,6 +56,7 @@ namespace Engine
         static ThreadManager* mThreadManager; ///< Singleton instance
         rigtorp::SPSCQueue<Message> mQueue;
         FARender::RenderState* mRenderState;
-        FAAudio::AudioManager mAudioManager;
+        bool mHeadless = false;
+        std::unique_ptr<FAAudio::AudioManager> mAudioManager; ///< nullptr when headless
     };
 }
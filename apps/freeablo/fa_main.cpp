@@ -17,6 +17,7 @@ bool parseOptions(int argc, char** argv, cxxopts::ParseResult& variables)
         ("l,level", "Level number to load (0-16)", cxxopts::value<int32_t>()->default_value("-1"))(
             "c,character", "Choose Warrior, Rogue or Sorceror", cxxopts::value<std::string>()->default_value("Warrior"))(
             "connect", "Ip Address or hostname to connect to", cxxopts::value<std::string>()->default_value(""))(
+            "spectate", "Watch the game at --connect without joining it", cxxopts::value<bool>()->default_value("false"))(
             "seed", "Seed for level generation", cxxopts::value<uint32_t>()->default_value("0"));
 
     try
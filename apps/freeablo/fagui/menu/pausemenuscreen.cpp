@@ -2,11 +2,9 @@
 #include "../../engine/enginemain.h"
 #include "../../farender/animationplayer.h"
 #include "../../farender/renderer.h"
-#include "../../fasavegame/gameloader.h"
 #include "../../faworld/world.h"
 #include "../menuhandler.h"
 #include "../nkhelpers.h"
-#include "serial/textstream.h"
 #include <cstring>
 #include <render/spritegroup.h>
 
@@ -53,17 +51,8 @@ namespace FAGui
             return func;
         };
 
-        FAWorld::World* world = Engine::EngineMain::get()->mWorld.get();
-        mMenuItems.push_back({drawItem("Save Game"), [this, world]() {
-                                  {
-                                      Serial::TextWriteStream writeStream;
-                                      FASaveGame::GameSaver saver(writeStream);
-                                      world->save(saver);
-                                      std::pair<uint8_t*, size_t> writtenData = writeStream.getData();
-                                      FILE* f = fopen("save.sav", "wb");
-                                      fwrite(writtenData.first, 1, writtenData.second, f);
-                                      fclose(f);
-                                  }
+        mMenuItems.push_back({drawItem("Save Game"), [this]() {
+                                  mMenuHandler.engine().saveGame("save.sav");
                                   mMenuHandler.engine().togglePause();
                                   return ActionResult::stopDrawing;
                               }});
@@ -127,6 +127,16 @@ namespace FAGui
                                       return ActionResult::stopDrawing;
                                   }});
         }
+
+        FILE* autosaveFile = fopen(Engine::EngineMain::AUTOSAVE_PATH, "rb");
+        if (autosaveFile)
+        {
+            fclose(autosaveFile);
+            mMenuItems.push_back({drawItem("Load Autosave", {262, 410, 320, 33}, FAWorld::PlayerClass::none), [&]() {
+                                      mMenuHandler.engine().startGameFromAutosave();
+                                      return ActionResult::stopDrawing;
+                                  }});
+        }
     }
 
     void SelectHeroMenuScreen::setType(ContentType type)
@@ -7,16 +7,24 @@
 #include <diabloexe/monster.h>
 #include <diabloexe/npc.h>
 #include <fmt/format.h>
+#include <misc/mappedfile.h>
 #include <misc/md5.h>
 #include <misc/stringops.h>
 #include <render/spritegroup.h>
-#include <serial/textstream.h>
+#include <serial/binarystream.h>
 #include <thread>
 
 namespace FARender
 {
+    SpriteLoader* SpriteLoader::mInstance = nullptr;
+
+    SpriteLoader* SpriteLoader::get() { return mInstance; }
+
     SpriteLoader::SpriteLoader(const DiabloExe::DiabloExe& exe)
     {
+        release_assert(!mInstance); // singleton, only one instance
+        mInstance = this;
+
         for (const auto& pair : exe.getMonsters())
         {
             const DiabloExe::Monster& monsterData = pair.second;
@@ -186,8 +194,16 @@ namespace FARender
             mSpritesToLoad.insert(*guiSpriteIt);
     }
 
+    SpriteLoader::~SpriteLoader() { mInstance = nullptr; }
+
     Render::SpriteGroup* SpriteLoader::getSprite(const SpriteDefinition& definition, GetSpriteFailAction fail)
     {
+        if (mMetadataOnly && !mLoadedSprites.count(definition) && mSpritesToLoad.count(definition))
+        {
+            if (Render::SpriteGroup* sprite = loadSpriteMetadata(definition))
+                return sprite;
+        }
+
         if (fail == GetSpriteFailAction::Error)
             return mLoadedSprites.at(definition).get();
 
@@ -198,7 +214,7 @@ namespace FARender
         return it->second.get();
     }
 
-    void SpriteLoader::load()
+    void SpriteLoader::removeBadSprites()
     {
         // TODO: This is a temporary hack, once we have a proper data loader, we just won't specify these
         static std::unordered_set<std::string> badCelNames{
@@ -219,6 +235,35 @@ namespace FARender
             else
                 ++it;
         }
+    }
+
+    void SpriteLoader::loadMetadataOnly()
+    {
+        removeBadSprites();
+        mMetadataOnly = true;
+    }
+
+    Render::SpriteGroup* SpriteLoader::loadSpriteMetadata(const SpriteDefinition& definition)
+    {
+        // Anything with extra parameters in the path is only used by the gui, see loadImagesIntoCpuMemory()
+        if (definition.path.find('&') != std::string::npos)
+            return nullptr;
+
+        std::string extension = Misc::StringUtils::getFileExtension(definition.path);
+        if (!Misc::StringUtils::ciEqual(extension, "cel") && !Misc::StringUtils::ciEqual(extension, "cl2"))
+            return nullptr;
+
+        Cel::CelFile cel(definition.path);
+        std::vector<const Render::TextureReference*> frames(size_t(cel.numFrames()), nullptr);
+
+        auto& sprite = mLoadedSprites[definition];
+        sprite = std::make_unique<Render::SpriteGroup>(std::move(frames), cel.animLength());
+        return sprite.get();
+    }
+
+    void SpriteLoader::load()
+    {
+        removeBadSprites();
 
         Render::setWindowTitle(Render::getWindowTitle() + ", trying to load sprites from cache...");
 
@@ -387,7 +432,7 @@ namespace FARender
             std::sort(allSpriteDefinitions.begin(), allSpriteDefinitions.end());
         }
 
-        Serial::TextWriteStream stream;
+        Serial::BinaryWriteStream stream;
         Serial::Saver saver(stream);
 
         saver.save(ATLAS_CACHE_VERSION);
@@ -446,7 +491,7 @@ namespace FARender
 
         std::pair<const uint8_t*, size_t> data = stream.getData();
 
-        FILE* f = fopen((atlasDirectory / "data.txt").str().c_str(), "wb");
+        FILE* f = fopen((atlasDirectory / "data.bin").str().c_str(), "wb");
         fwrite(data.first, 1, data.second, f);
         fclose(f);
     }
@@ -456,21 +501,11 @@ namespace FARender
         if (!atlasDirectory.exists())
             throw std::runtime_error("no cache to load");
 
-        std::string data;
-        {
-            if (!filesystem::exists(atlasDirectory / "data.txt"))
-                throw std::runtime_error("missing data.txt");
-
-            FILE* f = fopen((atlasDirectory / "data.txt").str().c_str(), "rb");
-            fseek(f, 0, SEEK_END);
-            size_t size = ftell(f);
-            fseek(f, 0, SEEK_SET);
-            data.resize(size);
-            fread(data.data(), 1, size, f);
-            fclose(f);
-        }
+        Misc::MappedFile data((atlasDirectory / "data.bin").str());
+        if (!data.isOpen())
+            throw std::runtime_error("missing data.bin");
 
-        Serial::TextReadStream stream(data);
+        Serial::BinaryReadStream stream(data.data(), data.size());
         Serial::Loader loader(stream);
 
         int32_t cachedVersion = loader.load<int32_t>();
@@ -549,7 +584,7 @@ namespace FARender
 
     SpriteLoader::SpriteDefinitionsHash SpriteLoader::hashSpriteDefinitions(const std::vector<SpriteDefinition>& definitions)
     {
-        Serial::TextWriteStream stream;
+        Serial::BinaryWriteStream stream;
         Serial::Saver saver(stream);
 
         saver.save(uint32_t(definitions.size()));
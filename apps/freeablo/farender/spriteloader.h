@@ -25,8 +25,18 @@ namespace FARender
     {
     public:
         explicit SpriteLoader(const DiabloExe::DiabloExe& exe);
+        ~SpriteLoader();
+
+        // The game world gets its sprites from here, so it doesn't need to care whether there is a renderer or not
+        static SpriteLoader* get();
+
         void load();
 
+        // For running without a renderer, eg on a headless server. Sprites are created when first requested, and only the
+        // frame counts of CEL / CL2 files are read, as those decide how long animations take, which affects the game simulation.
+        // The sprites have no textures, so they can't be drawn.
+        void loadMetadataOnly();
+
         struct SpriteDefinition
         {
             std::string path;
@@ -200,12 +210,18 @@ namespace FARender
         typedef std::array<uint8_t, 16> SpriteDefinitionsHash;
         static SpriteDefinitionsHash hashSpriteDefinitions(const std::vector<SpriteDefinition>& definitions);
 
+        void removeBadSprites();
+        Render::SpriteGroup* loadSpriteMetadata(const SpriteDefinition& definition);
+
     private:
+        static SpriteLoader* mInstance; ///< Singleton instance
+
+        bool mMetadataOnly = false;
         std::unordered_set<SpriteDefinition, SpriteDefinition::Hash> mSpritesToLoad;
         std::unordered_map<SpriteDefinition, std::unique_ptr<Render::SpriteGroup>, SpriteDefinition::Hash> mLoadedSprites;
         std::unique_ptr<Render::AtlasTexture> mAtlasTexture;
 
         const filesystem::path mAtlasDirectory = Misc::getResourcesPath() / "cache" / "atlas";
-        static constexpr int32_t ATLAS_CACHE_VERSION = 1;
+        static constexpr int32_t ATLAS_CACHE_VERSION = 3;
     };
 }
\ No newline at end of file
@@ -3,15 +3,15 @@
 
 namespace FASaveGame
 {
-    void ObjectIdMapper::addClass(const std::string& name, std::function<void*(GameLoader&)> constructor)
+    void ObjectIdMapper::addClass(TypeId typeId, std::function<void*(GameLoader&)> constructor)
     {
-        release_assert(!mMappings.count(name));
-        mMappings[name] = constructor;
+        release_assert(typeId < TypeId::count && !mConstructors[size_t(typeId)]);
+        mConstructors[size_t(typeId)] = std::move(constructor);
     }
 
-    void* ObjectIdMapper::construct(const std::string& name, GameLoader& gameLoader)
+    void* ObjectIdMapper::construct(TypeId typeId, GameLoader& gameLoader)
     {
-        release_assert(mMappings.count(name));
-        return mMappings[name](gameLoader);
+        release_assert(typeId < TypeId::count && mConstructors[size_t(typeId)]);
+        return mConstructors[size_t(typeId)](gameLoader);
     }
 }
@@ -1,20 +1,39 @@
 #pragma once
+#include <array>
 #include <cstdint>
 #include <functional>
-#include <string>
-#include <unordered_map>
 
 namespace FASaveGame
 {
     class GameLoader;
 
+    // Written to saves in front of polymorphic objects, so we know which class to construct when loading.
+    // The values are part of the save format, so only ever append to this list.
+    enum class TypeId : uint8_t
+    {
+        actor,
+        player,
+        monster,
+
+        nullBehaviour,
+        basicMonsterBehaviour,
+        playerBehaviour,
+
+        meleeAttackState,
+        rangedAttackState,
+        spellAttackState,
+        baseState,
+
+        count
+    };
+
     class ObjectIdMapper
     {
     public:
-        void addClass(const std::string& name, std::function<void*(GameLoader&)> constructor);
-        void* construct(const std::string& name, GameLoader& gameLoader);
+        void addClass(TypeId typeId, std::function<void*(GameLoader&)> constructor);
+        void* construct(TypeId typeId, GameLoader& gameLoader);
 
     private:
-        std::unordered_map<std::string, std::function<void*(GameLoader&)>> mMappings;
+        std::array<std::function<void*(GameLoader&)>, size_t(TypeId::count)> mConstructors;
     };
 }
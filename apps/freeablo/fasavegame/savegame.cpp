@@ -0,0 +1,196 @@
+#include "savegame.h"
+#include "../faworld/player.h"
+#include "../faworld/world.h"
+#include "gameloader.h"
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <misc/assert.h>
+#include <misc/mappedfile.h>
+#include <serial/binarystream.h>
+#include <serial/zlibstream.h>
+
+namespace FASaveGame
+{
+    namespace
+    {
+        // A world that has been serialised, but not yet compressed or written to disk
+        struct PendingSave
+        {
+            explicit PendingSave(const std::string& path) : path(path) {}
+
+            std::string path;
+            SaveGameHeader header;
+            Serial::BinaryWriteStream binaryStream;
+            Serial::ZlibWriteStream payloadStream{binaryStream, true};
+        };
+
+        std::unique_ptr<PendingSave> snapshotWorld(const std::string& path, FAWorld::World& world)
+        {
+            auto pendingSave = std::make_unique<PendingSave>(path);
+            {
+                GameSaver saver(pendingSave->payloadStream);
+                world.save(saver);
+            }
+            pendingSave->header = SaveGameHeader::fromWorld(world, 0);
+
+            return pendingSave;
+        }
+
+        bool writePendingSave(PendingSave& pendingSave)
+        {
+            std::pair<uint8_t*, size_t> payload = pendingSave.payloadStream.getData();
+            pendingSave.header.payloadSize = payload.second;
+
+            Serial::BinaryWriteStream headerStream;
+            pendingSave.header.save(headerStream);
+            std::pair<uint8_t*, size_t> header = headerStream.getData();
+
+            FILE* f = fopen(pendingSave.path.c_str(), "wb");
+            if (!f)
+                return false;
+
+            bool success = fwrite(header.first, 1, header.second, f) == header.second && fwrite(payload.first, 1, payload.second, f) == payload.second;
+            success = fclose(f) == 0 && success;
+
+            return success;
+        }
+    }
+
+    SaveGameHeader SaveGameHeader::fromWorld(FAWorld::World& world, uint64_t payloadSize)
+    {
+        SaveGameHeader header;
+
+        if (FAWorld::Player* player = world.getCurrentPlayer())
+        {
+            header.characterName = player->getName();
+            header.characterClass = player->getClass();
+            header.characterLevel = player->getStats().mLevel;
+            header.dungeonLevel = world.getCurrentLevelIndex();
+        }
+
+        header.timestamp = int64_t(time(nullptr));
+        header.payloadSize = payloadSize;
+
+        return header;
+    }
+
+    void SaveGameHeader::save(Serial::BinaryWriteStream& stream) const
+    {
+        size_t startSize = stream.getCurrentSize();
+
+        stream.write(MAGIC);
+        stream.write(saveVersion);
+
+        for (size_t i = 0; i < NAME_SIZE; i++)
+            stream.write(uint8_t(i < characterName.size() ? characterName[i] : 0));
+
+        stream.write(uint8_t(characterClass));
+        stream.write(characterLevel);
+        stream.write(dungeonLevel);
+        stream.write(timestamp);
+        stream.write(payloadSize);
+
+        release_assert(stream.getCurrentSize() - startSize == SIZE);
+    }
+
+    std::optional<SaveGameHeader> SaveGameHeader::load(const uint8_t* data, size_t size)
+    {
+        if (size < SIZE)
+            return std::nullopt;
+
+        Serial::BinaryReadStream stream(data, SIZE);
+
+        if (stream.read_uint32_t() != MAGIC)
+            return std::nullopt;
+
+        SaveGameHeader header;
+        header.saveVersion = stream.read_uint32_t();
+
+        for (size_t i = 0; i < NAME_SIZE; i++)
+        {
+            char c = char(stream.read_uint8_t());
+            if (c != 0)
+                header.characterName += c;
+        }
+
+        uint8_t characterClass = stream.read_uint8_t();
+        if (characterClass > uint8_t(FAWorld::PlayerClass::none))
+            return std::nullopt;
+
+        header.characterClass = FAWorld::PlayerClass(characterClass);
+        header.characterLevel = stream.read_int32_t();
+        header.dungeonLevel = stream.read_int32_t();
+        header.timestamp = stream.read_int64_t();
+        header.payloadSize = stream.read_uint64_t();
+
+        return header;
+    }
+
+    std::optional<SaveGameHeader> readSaveGameHeader(const std::string& path)
+    {
+        FILE* f = fopen(path.c_str(), "rb");
+        if (!f)
+            return std::nullopt;
+
+        uint8_t data[SaveGameHeader::SIZE];
+        size_t bytesRead = fread(data, 1, SaveGameHeader::SIZE, f);
+        fclose(f);
+
+        return SaveGameHeader::load(data, bytesRead);
+    }
+
+    bool writeSaveGame(const std::string& path, FAWorld::World& world) { return writePendingSave(*snapshotWorld(path, world)); }
+
+    bool loadSaveGame(const std::string& path, FAWorld::World& world)
+    {
+        // The payload is decompressed straight out of the mapping, so the compressed file is never copied into memory
+        Misc::MappedFile file(path);
+        if (!file.isOpen())
+            return false;
+
+        std::optional<SaveGameHeader> header = SaveGameHeader::load(file.data(), file.size());
+
+        if (!header || header->saveVersion > Serial::CurrentSaveVersion || header->saveVersion < Serial::MinimumSupportedSaveVersion)
+            return false;
+
+        if (header->payloadSize > file.size() - SaveGameHeader::SIZE)
+            return false;
+
+        Serial::ZlibReadStream stream(file.data() + SaveGameHeader::SIZE, header->payloadSize, [](const uint8_t* data, size_t size) {
+            return std::make_unique<Serial::BinaryReadStream>(data, size);
+        });
+        GameLoader loader(stream);
+
+        world.load(loader);
+        return true;
+    }
+
+    BackgroundSaver::~BackgroundSaver() { waitUntilDone(); }
+
+    bool BackgroundSaver::startSave(const std::string& path, FAWorld::World& world)
+    {
+        if (mSaving)
+            return false;
+
+        waitUntilDone();
+
+        std::unique_ptr<PendingSave> pendingSave = snapshotWorld(path, world);
+
+        mSaving = true;
+        mThread = std::thread([this, pendingSave = std::move(pendingSave)]() {
+            if (!writePendingSave(*pendingSave))
+                std::cerr << "Failed to write " << pendingSave->path << std::endl;
+
+            mSaving = false;
+        });
+
+        return true;
+    }
+
+    void BackgroundSaver::waitUntilDone()
+    {
+        if (mThread.joinable())
+            mThread.join();
+    }
+}
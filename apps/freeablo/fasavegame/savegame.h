@@ -0,0 +1,68 @@
+#pragma once
+#include "../faworld/enums.h"
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <serial/loader.h>
+#include <string>
+#include <thread>
+
+namespace Serial
+{
+    class BinaryWriteStream;
+}
+
+namespace FAWorld
+{
+    class World;
+}
+
+namespace FASaveGame
+{
+    // Fixed size header at the start of every save file, so we can list saves without loading the whole world.
+    // The (compressed) world data follows directly after it.
+    struct SaveGameHeader
+    {
+        static constexpr uint32_t MAGIC = 0x56534146; // "FASV"
+        static constexpr size_t NAME_SIZE = 32;
+        static constexpr size_t SIZE = sizeof(uint32_t) * 2 + NAME_SIZE + sizeof(uint8_t) + sizeof(int32_t) * 2 + sizeof(int64_t) + sizeof(uint64_t);
+
+        uint32_t saveVersion = Serial::CurrentSaveVersion;
+        std::string characterName; ///< truncated to NAME_SIZE bytes when saved
+        FAWorld::PlayerClass characterClass = FAWorld::PlayerClass::none;
+        int32_t characterLevel = 0;
+        int32_t dungeonLevel = 0;
+        int64_t timestamp = 0; ///< seconds since the unix epoch
+        uint64_t payloadSize = 0;
+
+        static SaveGameHeader fromWorld(FAWorld::World& world, uint64_t payloadSize);
+
+        // Always writes exactly SIZE bytes
+        void save(Serial::BinaryWriteStream& stream) const;
+        static std::optional<SaveGameHeader> load(const uint8_t* data, size_t size);
+    };
+
+    // Reads only the header of a save file, returns std::nullopt if the file is missing or is not a save
+    std::optional<SaveGameHeader> readSaveGameHeader(const std::string& path);
+
+    bool writeSaveGame(const std::string& path, FAWorld::World& world);
+    bool loadSaveGame(const std::string& path, FAWorld::World& world);
+
+    // Serialises the world on the calling thread, then compresses it and writes it to disk on a background thread,
+    // so a save doesn't eat into the game tick.
+    class BackgroundSaver
+    {
+    public:
+        BackgroundSaver() = default;
+        ~BackgroundSaver();
+
+        // Returns false without doing anything if the previous save is still being written
+        bool startSave(const std::string& path, FAWorld::World& world);
+        bool isSaving() const { return mSaving; }
+        void waitUntilDone();
+
+    private:
+        std::thread mThread;
+        std::atomic_bool mSaving = false;
+    };
+}
@@ -0,0 +1,226 @@
+#include "savejournal.h"
+#include "../faworld/gamelevel.h"
+#include "../faworld/world.h"
+#include "gameloader.h"
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <misc/mappedfile.h>
+#include <serial/binarystream.h>
+#include <serial/zlibstream.h>
+#include <vector>
+
+namespace FASaveGame
+{
+    namespace
+    {
+        constexpr size_t FILE_HEADER_SIZE = sizeof(uint32_t) * 2;
+        constexpr size_t ENTRY_HEADER_SIZE = sizeof(uint64_t);
+
+        std::string toString(Serial::BinaryWriteStream& stream)
+        {
+            std::pair<uint8_t*, size_t> data = stream.getData();
+            return std::string(reinterpret_cast<const char*>(data.first), data.second);
+        }
+
+        bool writeAll(FILE* f, Serial::WriteStreamInterface& stream)
+        {
+            std::pair<uint8_t*, size_t> data = stream.getData();
+            return fwrite(data.first, 1, data.second, f) == data.second;
+        }
+    }
+
+    // An entry that has been serialised, but not yet compressed or written to disk
+    struct SaveJournal::PendingEntry
+    {
+        bool full = false;
+        Serial::BinaryWriteStream entryStream;
+        Serial::ZlibWriteStream compressedEntryStream{entryStream, true};
+    };
+
+    SaveJournal::~SaveJournal() { waitUntilDone(); }
+
+    bool SaveJournal::startAppend(FAWorld::World& world)
+    {
+        if (mWriting)
+            return false;
+
+        // We don't know what state the file is in after a failed write, so start from scratch
+        if (!waitUntilDone())
+            mEntries = 0;
+        mLastWriteFailed = false;
+
+        auto entry = std::make_unique<PendingEntry>();
+        entry->full = mEntries == 0 || mEntries >= MAX_ENTRIES_BEFORE_COMPACTION;
+        if (entry->full)
+            mSavedLevels.clear();
+
+        {
+            GameSaver entrySaver(entry->compressedEntryStream);
+
+            Serial::BinaryWriteStream globalsStream;
+            {
+                GameSaver saver(globalsStream);
+                world.saveGlobals(saver);
+            }
+            entrySaver.save(toString(globalsStream));
+
+            std::vector<int32_t> levelIndices;
+            for (const auto& pair : world.getLevels())
+            {
+                if (!mSavedLevels.count(pair.first) || (pair.second && pair.second->isDirty()))
+                    levelIndices.push_back(pair.first);
+            }
+
+            entrySaver.save(uint32_t(levelIndices.size()));
+            for (int32_t levelIndex : levelIndices)
+            {
+                Serial::BinaryWriteStream levelStream;
+                {
+                    GameSaver saver(levelStream);
+                    world.saveLevel(saver, levelIndex);
+                }
+
+                entrySaver.save(levelIndex);
+                entrySaver.save(toString(levelStream));
+
+                // The entry holds the level as it is now, so it's clean as far as the journal is concerned,
+                // and if the write fails the next entry is a full snapshot anyway
+                if (FAWorld::GameLevel* level = world.getLevels().at(levelIndex))
+                    level->clearDirty();
+                mSavedLevels.insert(levelIndex);
+            }
+        }
+
+        mEntries = entry->full ? 1 : mEntries + 1;
+
+        mWriting = true;
+        mThread = std::thread([this, entry = std::move(entry)]() {
+            mLastWriteFailed = !writeEntry(mPath, *entry);
+            if (mLastWriteFailed)
+                std::cerr << "Failed to write " << mPath << std::endl;
+
+            mWriting = false;
+        });
+
+        return true;
+    }
+
+    bool SaveJournal::waitUntilDone()
+    {
+        if (mThread.joinable())
+            mThread.join();
+
+        return !mLastWriteFailed;
+    }
+
+    bool SaveJournal::append(FAWorld::World& world) { return startAppend(world) && waitUntilDone(); }
+
+    bool SaveJournal::writeEntry(const std::string& path, PendingEntry& entry)
+    {
+        entry.compressedEntryStream.finish();
+
+        Serial::BinaryWriteStream entryHeaderStream;
+        entryHeaderStream.write(uint64_t(entry.compressedEntryStream.getCurrentSize()));
+
+        bool success = false;
+        if (entry.full)
+        {
+            // Write the snapshot to a temporary file first, so we don't lose the previous journal if something goes wrong
+            std::string tmpPath = path + ".tmp";
+            if (FILE* f = fopen(tmpPath.c_str(), "wb"))
+            {
+                Serial::BinaryWriteStream fileHeaderStream;
+                fileHeaderStream.write(MAGIC);
+                fileHeaderStream.write(Serial::CurrentSaveVersion);
+
+                success = writeAll(f, fileHeaderStream) && writeAll(f, entryHeaderStream) && writeAll(f, entry.compressedEntryStream);
+                success = fclose(f) == 0 && success;
+
+                if (success)
+                {
+                    // rename won't overwrite an existing file on windows
+                    remove(path.c_str());
+                    success = rename(tmpPath.c_str(), path.c_str()) == 0;
+                }
+            }
+        }
+        else if (FILE* f = fopen(path.c_str(), "ab"))
+        {
+            success = writeAll(f, entryHeaderStream) && writeAll(f, entry.compressedEntryStream);
+            success = fclose(f) == 0 && success;
+        }
+
+        return success;
+    }
+
+    bool SaveJournal::load(const std::string& path, FAWorld::World& world)
+    {
+        Misc::MappedFile data(path);
+        if (!data.isOpen() || data.size() < FILE_HEADER_SIZE)
+            return false;
+
+        {
+            Serial::BinaryReadStream fileHeaderStream(data.data(), FILE_HEADER_SIZE);
+            uint32_t magic = fileHeaderStream.read_uint32_t();
+            uint32_t version = fileHeaderStream.read_uint32_t();
+
+            if (magic != MAGIC || version > Serial::CurrentSaveVersion || version < Serial::MinimumSupportedSaveVersion)
+                return false;
+        }
+
+        // Later entries replace the data from earlier ones
+        std::string globals;
+        std::map<int32_t, std::string> levels;
+
+        size_t position = FILE_HEADER_SIZE;
+        while (position + ENTRY_HEADER_SIZE <= data.size())
+        {
+            uint64_t entrySize = Serial::BinaryReadStream(data.data() + position, ENTRY_HEADER_SIZE).read_uint64_t();
+            if (entrySize > data.size() - position - ENTRY_HEADER_SIZE)
+                break;
+
+            position += ENTRY_HEADER_SIZE;
+
+            Serial::ZlibReadStream entryStream(
+                data.data() + position, entrySize, [](const uint8_t* chunk, size_t size) { return std::make_unique<Serial::BinaryReadStream>(chunk, size); });
+            GameLoader entryLoader(entryStream);
+
+            globals = entryLoader.load<std::string>();
+
+            uint32_t levelCount = entryLoader.load<uint32_t>();
+            for (uint32_t i = 0; i < levelCount; i++)
+            {
+                int32_t levelIndex = entryLoader.load<int32_t>();
+                levels[levelIndex] = entryLoader.load<std::string>();
+            }
+
+            position += entrySize;
+        }
+
+        if (globals.empty())
+            return false;
+
+        auto makeStream = [](const std::string& str) {
+            return std::make_unique<Serial::BinaryReadStream>(reinterpret_cast<const uint8_t*>(str.data()), str.size());
+        };
+
+        std::unique_ptr<Serial::BinaryReadStream> globalsStream = makeStream(globals);
+        GameLoader globalsLoader(*globalsStream);
+
+        std::vector<std::unique_ptr<Serial::BinaryReadStream>> levelStreams;
+        std::vector<std::unique_ptr<GameLoader>> levelLoaderStorage;
+        std::map<int32_t, GameLoader*> levelLoaders;
+
+        for (const auto& pair : levels)
+        {
+            levelStreams.push_back(makeStream(pair.second));
+            levelLoaderStorage.push_back(std::make_unique<GameLoader>(*levelStreams.back()));
+            levelLoaders[pair.first] = levelLoaderStorage.back().get();
+        }
+
+        world.load(globalsLoader, levelLoaders);
+        return true;
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+
+namespace FAWorld
+{
+    class World;
+}
+
+namespace FASaveGame
+{
+    // Append-only autosave file. Each entry holds the world globals, plus only the levels that have changed since the previous entry,
+    // so the cost of an autosave depends on what the players have been doing, not on how many levels they have visited.
+    // Every MAX_ENTRIES_BEFORE_COMPACTION entries the file is rewritten with a single entry containing the whole world.
+    // Changes are tracked with GameLevel::isDirty(), so there should only be one journal writing a world at a time.
+    // Like BackgroundSaver, entries are serialised on the calling thread, then compressed and written on a background thread.
+    class SaveJournal
+    {
+    public:
+        explicit SaveJournal(const std::string& path) : mPath(path) {}
+        ~SaveJournal();
+
+        // The first entry written by a journal is always a full snapshot, which replaces whatever was in the file before.
+        // Returns false without doing anything if the previous entry is still being written.
+        bool startAppend(FAWorld::World& world);
+        bool isWriting() const { return mWriting; }
+
+        // Returns false if the last entry could not be written
+        bool waitUntilDone();
+
+        // startAppend() followed by waitUntilDone()
+        bool append(FAWorld::World& world);
+
+        // Entries that were only partially written (eg, if we crashed while saving) are ignored
+        static bool load(const std::string& path, FAWorld::World& world);
+
+        static constexpr uint32_t MAGIC = 0x4a534146; // "FASJ"
+        static constexpr size_t MAX_ENTRIES_BEFORE_COMPACTION = 32;
+
+    private:
+        struct PendingEntry;
+        static bool writeEntry(const std::string& path, PendingEntry& entry);
+
+        std::string mPath;
+        size_t mEntries = 0;
+        std::set<int32_t> mSavedLevels;
+
+        std::thread mThread;
+        std::atomic_bool mWriting = false;
+        bool mLastWriteFailed = false; ///< set by the writing thread, only read once it has been joined
+    };
+}
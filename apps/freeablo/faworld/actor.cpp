@@ -17,8 +17,6 @@
 
 namespace FAWorld
 {
-    const std::string Actor::typeId = "base_actor";
-
     void Actor::update(bool noclip)
     {
         if (!isDead())
@@ -80,7 +78,7 @@ namespace FAWorld
         bool hasBehaviour = loader.load<bool>();
         if (hasBehaviour)
         {
-            std::string typeId = loader.load<std::string>();
+            FASaveGame::TypeId typeId = FASaveGame::TypeId(loader.load<uint8_t>());
             mBehaviour.reset(static_cast<Behaviour*>(mWorld.mObjectIdMapper.construct(typeId, loader)));
             loader.addFunctionToRunAtEnd([this]() { mBehaviour->reAttach(this); });
         }
@@ -139,7 +137,7 @@ namespace FAWorld
 
         if (hasBehaviour)
         {
-            saver.save(mBehaviour->getTypeId());
+            saver.save(uint8_t(mBehaviour->getTypeId()));
             mBehaviour->save(saver);
         }
 
@@ -437,7 +435,7 @@ namespace FAWorld
 
     void Actor::restoreAnimationsForNpc()
     {
-        FARender::SpriteLoader& spriteLoader = FARender::Renderer::get()->mSpriteLoader;
+        FARender::SpriteLoader& spriteLoader = *FARender::SpriteLoader::get();
         mAnimation.setAnimationSprites(AnimState::idle, spriteLoader.getSprite(spriteLoader.mNpcIdleAnimations[mNpcId]));
         mAnimation.markAnimationsRestoredAfterGameLoad();
     }
@@ -39,8 +39,8 @@ namespace FAWorld
     class Actor
     {
     public:
-        static const std::string typeId;
-        virtual const std::string& getTypeId() { return typeId; }
+        static constexpr FASaveGame::TypeId typeId = FASaveGame::TypeId::actor;
+        virtual FASaveGame::TypeId getTypeId() { return typeId; }
 
         explicit Actor(World& world);
         Actor(World& world, const DiabloExe::Npc& npc, const DiabloExe::DiabloExe& exe);
@@ -92,6 +92,7 @@ namespace FAWorld
         virtual bool castSpell(SpellId spell, Misc::Point targetPoint);
         virtual void doSpellEffect(SpellId spell, Misc::Point targetPoint);
         ActorType getType() const { return mType; }
+        Behaviour* getBehaviour() { return mBehaviour.get(); }
         bool isRecoveringFromHit() const;
         int32_t getMeleeHitFrame() const { return mMeleeHitFrame; }
 
@@ -53,8 +53,6 @@ namespace FAWorld
             actor.mAnimation.playAnimation(getAnimation(), FARender::AnimationPlayer::AnimationType::Once);
         }
 
-        const std::string MeleeAttackState::typeId = "actorstate-melee-attack-state";
-
         void MeleeAttackState::doAttack(Actor& actor)
         {
             // Melee can only attack the nearest position/tile in a direction.
@@ -66,12 +64,8 @@ namespace FAWorld
 
         int32_t MeleeAttackState::getAttackFrame(Actor& actor) const { return actor.getMeleeHitFrame(); }
 
-        const std::string RangedAttackState::typeId = "actorstate-ranged-attack-state";
-
         void RangedAttackState::doAttack(Actor& actor) { actor.doRangedAttack(mTargetPoint); }
 
-        const std::string SpellAttackState::typeId = "actorstate-spell-attack-state";
-
         void SpellAttackState::save(FASaveGame::GameSaver& saver) const
         {
             BaseAttackState::save(saver);
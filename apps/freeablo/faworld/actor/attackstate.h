@@ -35,8 +35,8 @@ namespace FAWorld
         class MeleeAttackState : public BaseAttackState
         {
         public:
-            static const std::string typeId;
-            const std::string& getTypeId() const override { return typeId; }
+            static constexpr FASaveGame::TypeId typeId = FASaveGame::TypeId::meleeAttackState;
+            FASaveGame::TypeId getTypeId() const override { return typeId; }
 
             explicit MeleeAttackState(FASaveGame::GameLoader& loader) : BaseAttackState(loader) {}
             explicit MeleeAttackState(Misc::Point targetPoint) : BaseAttackState(targetPoint) {}
@@ -50,8 +50,8 @@ namespace FAWorld
         class RangedAttackState : public MeleeAttackState
         {
         public:
-            static const std::string typeId;
-            const std::string& getTypeId() const override { return typeId; }
+            static constexpr FASaveGame::TypeId typeId = FASaveGame::TypeId::rangedAttackState;
+            FASaveGame::TypeId getTypeId() const override { return typeId; }
 
             explicit RangedAttackState(FASaveGame::GameLoader& loader) : MeleeAttackState(loader) {}
             explicit RangedAttackState(Misc::Point targetPoint) : MeleeAttackState(targetPoint) {}
@@ -63,8 +63,8 @@ namespace FAWorld
         class SpellAttackState : public BaseAttackState
         {
         public:
-            static const std::string typeId;
-            const std::string& getTypeId() const override { return typeId; }
+            static constexpr FASaveGame::TypeId typeId = FASaveGame::TypeId::spellAttackState;
+            FASaveGame::TypeId getTypeId() const override { return typeId; }
 
             void save(FASaveGame::GameSaver& saver) const override;
 
@@ -7,8 +7,6 @@ namespace FAWorld
 {
     namespace ActorState
     {
-        const std::string BaseState::typeId = "actor-state-base-state";
-
         std::optional<StateChange> BaseState::update(Actor& actor, bool noclip)
         {
             UNUSED_PARAM(noclip);
@@ -16,8 +16,8 @@ namespace FAWorld
         public:
             ~BaseState() = default;
 
-            static const std::string typeId;
-            const std::string& getTypeId() const override { return typeId; }
+            static constexpr FASaveGame::TypeId typeId = FASaveGame::TypeId::baseState;
+            FASaveGame::TypeId getTypeId() const override { return typeId; }
 
             virtual void save(FASaveGame::GameSaver&) const override {}
 
@@ -16,7 +16,7 @@ namespace FAWorld
         saver.save(stackSize);
         for (const auto& state : mStateStack)
         {
-            saver.save(state->getTypeId());
+            saver.save(uint8_t(state->getTypeId()));
             state->save(saver);
         }
     }
@@ -26,7 +26,7 @@ namespace FAWorld
         uint32_t stackSize = loader.load<uint32_t>();
         for (uint32_t i = 0; i < stackSize; i++)
         {
-            std::string typeId = loader.load<std::string>();
+            FASaveGame::TypeId typeId = FASaveGame::TypeId(loader.load<uint8_t>());
             auto state = static_cast<AbstractState*>(loader.currentlyLoadingWorld->mObjectIdMapper.construct(typeId, loader));
             mStateStack.emplace_back(state);
         }
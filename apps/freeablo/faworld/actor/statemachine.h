@@ -1,4 +1,5 @@
 #pragma once
+#include "../../fasavegame/objectidmapper.h"
 #include <memory>
 #include <misc/misc.h>
 #include <optional>
@@ -26,7 +27,7 @@ namespace FAWorld
     {
     public:
         virtual void save(FASaveGame::GameSaver& saver) const = 0;
-        virtual const std::string& getTypeId() const = 0;
+        virtual FASaveGame::TypeId getTypeId() const = 0;
         virtual ~AbstractState() = default;
         virtual std::optional<StateChange> update(Actor& entity, bool noclip) = 0;
         virtual void onEnter(Actor& entity) { UNUSED_PARAM(entity); }
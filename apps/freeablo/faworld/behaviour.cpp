@@ -10,9 +10,6 @@
 
 namespace FAWorld
 {
-    const std::string BasicMonsterBehaviour::typeId = "basic-monster-behaviour";
-    const std::string NullBehaviour::typeId = "null-behaviour";
-
     static int32_t squaredDistance(const Position& a, const Position& b)
     {
         int32_t tmpX = abs(a.current().x - b.current().x);
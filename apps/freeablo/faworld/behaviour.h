@@ -20,7 +20,7 @@ namespace FAWorld
         Behaviour(Actor* actor) { mActor = actor; }
         Behaviour() = default;
 
-        virtual const std::string& getTypeId() = 0;
+        virtual FASaveGame::TypeId getTypeId() = 0;
         virtual void save(FASaveGame::GameSaver& saver) const = 0;
         virtual void update() = 0;
 
@@ -35,8 +35,8 @@ namespace FAWorld
     class NullBehaviour : public Behaviour
     {
     public:
-        static const std::string typeId;
-        const std::string& getTypeId() override { return typeId; }
+        static constexpr FASaveGame::TypeId typeId = FASaveGame::TypeId::nullBehaviour;
+        FASaveGame::TypeId getTypeId() override { return typeId; }
 
         NullBehaviour(FAWorld::Actor* actor) : Behaviour(actor) {}
         NullBehaviour() = default;
@@ -50,8 +50,8 @@ namespace FAWorld
     class BasicMonsterBehaviour : public Behaviour
     {
     public:
-        static const std::string typeId;
-        const std::string& getTypeId() override { return typeId; }
+        static constexpr FASaveGame::TypeId typeId = FASaveGame::TypeId::basicMonsterBehaviour;
+        FASaveGame::TypeId getTypeId() override { return typeId; }
 
         BasicMonsterBehaviour(FAWorld::Actor* monster) : Behaviour(monster) {}
         BasicMonsterBehaviour(FASaveGame::GameLoader& loader);
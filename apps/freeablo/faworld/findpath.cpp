@@ -2,38 +2,25 @@
 #include "gamelevel.h"
 #include <algorithm>
 #include <cmath>
-#include <cstring>
-#include <misc/array2d.h>
-#include <misc/stdhashes.h>
-#include <queue>
 
 namespace
 {
     const int STRAIGHT_WEIGHT = 10;
     const int DIAGONAL_WEIGHT = 14;
 
+    const int32_t MAX_ITERATIONS = 1000;
+
+    // Jump point search expands few nodes, but scans along lines of tiles to find them. This bounds the scanning,
+    // and is enough to scan every tile of a full size level several times over.
+    const int32_t MAX_JUMP_TILES = 100 * 100 * 4;
+
+    int32_t sign(int32_t value) { return (value > 0) - (value < 0); }
+
     int distanceCost(const Misc::Point& a, const Misc::Point& b) { return (a.x != b.x && a.y != b.y) ? DIAGONAL_WEIGHT : STRAIGHT_WEIGHT; }
 }
 
 namespace FAWorld
 {
-    template <typename T, typename Number = size_t> struct PriorityQueue
-    {
-        typedef std::pair<Number, T> PQElement;
-        std::priority_queue<PQElement, std::vector<PQElement>, std::greater<PQElement>> elements;
-
-        inline bool empty() { return elements.empty(); }
-
-        inline void put(T item, Number priority) { elements.emplace(priority, item); }
-
-        inline T get()
-        {
-            T best_item = elements.top().second;
-            elements.pop();
-            return best_item;
-        }
-    };
-
     bool inBounds(GameLevelImpl* level, Misc::Point location)
     {
         int x = location.x;
@@ -41,6 +28,15 @@ namespace FAWorld
         return 0 <= x && x < (int)level->width() && 0 <= y && y < (int)level->height();
     }
 
+    bool walkable(GameLevelImpl* level, const Actor* actor, Misc::Point location) { return inBounds(level, location) && level->isPassable(location, actor); }
+
+    bool reachedGoal(Misc::Point location, Misc::Point goal, bool stopAdjacent)
+    {
+        if (location == goal)
+            return true;
+        return stopAdjacent && abs(goal.x - location.x) <= 1 && abs(goal.y - location.y) <= 1;
+    }
+
     Misc::Points neighbors(GameLevelImpl* level, const Actor* actor, const Misc::Point& location)
     {
         int x = location.x;
@@ -73,29 +69,44 @@ namespace FAWorld
         return straight * STRAIGHT_WEIGHT + diagonal * DIAGONAL_WEIGHT;
     }
 
-    bool AStarSearch(GameLevelImpl* level,
-                     const Actor* actor,
-                     Misc::Point start,
-                     Misc::Point& goal,
-                     std::unordered_map<Misc::Point, Misc::Point>& came_from,
-                     bool findAdjacent)
+    void PathFindContext::startSearch(int32_t width, int32_t height)
     {
-        auto goalPassable = level->isPassable(goal, actor);
-        PriorityQueue<Misc::Point> frontier;
-        frontier.put(start, 0);
-        came_from[start] = start;
+        mOpen.clear();
+        mGeneration++;
+
+        // Starting again from generation 1 when the level changes (or the counter wraps) means no stale entry can match
+        if (width != mWidth || height != mHeight || mGeneration == 0)
+        {
+            mWidth = width;
+            mHeight = height;
+
+            size_t size = size_t(width) * size_t(height);
+            mCostSoFar.resize(size);
+            mCameFrom.resize(size);
+            mTileGeneration.assign(size, 0);
+            mGeneration = 1;
+        }
+    }
 
-        static Misc::Array2D<int32_t> costSoFar;
-        costSoFar.resize(level->width(), level->height());
-        memset(costSoFar.data(), 0xff, level->width() * level->height() * sizeof(int32_t));
+    bool PathFindContext::search(GameLevelImpl* level, const Actor* actor, Misc::Point start, Misc::Point& goal, bool findAdjacent)
+    {
+        auto goalPassable = level->isPassable(goal, actor);
+        startSearch(level->width(), level->height());
 
-        costSoFar.get(start.x, start.y) = 0;
+        size_t startIndex = tileIndex(start);
+        mTileGeneration[startIndex] = mGeneration;
+        mCostSoFar[startIndex] = 0;
+        mCameFrom[startIndex] = int32_t(startIndex);
+        mOpen.push_back(OpenNode{0, start});
 
         int32_t iterations = 0;
-        while (!frontier.empty() && iterations < 1000)
+        while (!mOpen.empty() && iterations < MAX_ITERATIONS)
         {
             iterations++;
-            Misc::Point current = frontier.get();
+
+            std::pop_heap(mOpen.begin(), mOpen.end(), openNodeGreater);
+            Misc::Point current = mOpen.back().point;
+            mOpen.pop_back();
 
             // Early exit
             if (current == goal)
@@ -109,15 +120,184 @@ namespace FAWorld
                 }
             }
 
-            for (const auto& next : neighbors(level, actor, current))
+            size_t currentIndex = tileIndex(current);
+            int32_t currentCost = mCostSoFar[currentIndex];
+
+            // Same as neighbors(), but without building a list
+            for (int32_t dy = -1; dy <= 1; dy++)
+            {
+                for (int32_t dx = -1; dx <= 1; dx++)
+                {
+                    Misc::Point next(current.x + dx, current.y + dy);
+                    if (!inBounds(level, next) || !level->isPassable(next, actor))
+                        continue;
+
+                    size_t nextIndex = tileIndex(next);
+                    int32_t newCost = currentCost + distanceCost(current, next);
+
+                    if (!visited(nextIndex) || newCost < mCostSoFar[nextIndex])
+                    {
+                        mTileGeneration[nextIndex] = mGeneration;
+                        mCostSoFar[nextIndex] = newCost;
+                        mCameFrom[nextIndex] = int32_t(currentIndex);
+
+                        mOpen.push_back(OpenNode{newCost + heuristic(next, goal), next});
+                        std::push_heap(mOpen.begin(), mOpen.end(), openNodeGreater);
+                    }
+                }
+            }
+        }
+
+        return false;
+    }
+
+    bool PathFindContext::jump(
+        GameLevelImpl* level, const Actor* actor, Misc::Point from, int32_t dx, int32_t dy, const Misc::Point& goal, bool stopAdjacent, Misc::Point& jumpPoint)
+    {
+        Misc::Point current = from;
+        while (true)
+        {
+            Misc::Point next(current.x + dx, current.y + dy);
+            if (mJumpTilesLeft <= 0 || !walkable(level, actor, next))
+                return false;
+            mJumpTilesLeft--;
+
+            jumpPoint = next;
+            if (reachedGoal(next, goal, stopAdjacent))
+                return true;
+
+            // Stop wherever a wall beside us opens up a tile that can only be reached optimally through this one (a "forced neighbour")
+            int32_t x = next.x;
+            int32_t y = next.y;
+            if (dx != 0 && dy != 0)
+            {
+                if ((!walkable(level, actor, {x - dx, y}) && walkable(level, actor, {x - dx, y + dy})) ||
+                    (!walkable(level, actor, {x, y - dy}) && walkable(level, actor, {x + dx, y - dy})))
+                    return true;
+
+                // A diagonal step is also a jump point if either of the straight lines leaving it finds one
+                Misc::Point unused;
+                if (jump(level, actor, next, dx, 0, goal, stopAdjacent, unused) || jump(level, actor, next, 0, dy, goal, stopAdjacent, unused))
+                {
+                    jumpPoint = next;
+                    return true;
+                }
+            }
+            else if (dx != 0)
+            {
+                if ((!walkable(level, actor, {x, y + 1}) && walkable(level, actor, {x + dx, y + 1})) ||
+                    (!walkable(level, actor, {x, y - 1}) && walkable(level, actor, {x + dx, y - 1})))
+                    return true;
+            }
+            else
+            {
+                if ((!walkable(level, actor, {x + 1, y}) && walkable(level, actor, {x + 1, y + dy})) ||
+                    (!walkable(level, actor, {x - 1, y}) && walkable(level, actor, {x - 1, y + dy})))
+                    return true;
+            }
+
+            current = next;
+        }
+    }
+
+    bool PathFindContext::searchJumpPoints(GameLevelImpl* level, const Actor* actor, Misc::Point start, Misc::Point& goal, bool findAdjacent)
+    {
+        bool stopAdjacent = findAdjacent || !level->isPassable(goal, actor);
+        startSearch(level->width(), level->height());
+        mJumpTilesLeft = MAX_JUMP_TILES;
+
+        size_t startIndex = tileIndex(start);
+        mTileGeneration[startIndex] = mGeneration;
+        mCostSoFar[startIndex] = 0;
+        mCameFrom[startIndex] = int32_t(startIndex);
+        mOpen.push_back(OpenNode{0, start});
+
+        int32_t iterations = 0;
+        while (!mOpen.empty() && iterations < MAX_ITERATIONS && mJumpTilesLeft > 0)
+        {
+            iterations++;
+
+            std::pop_heap(mOpen.begin(), mOpen.end(), openNodeGreater);
+            Misc::Point current = mOpen.back().point;
+            mOpen.pop_back();
+
+            if (reachedGoal(current, goal, stopAdjacent))
             {
-                auto new_cost = costSoFar.get(current.x, current.y) + distanceCost(current, next);
+                goal = current;
+                return true;
+            }
 
-                if (costSoFar.get(next.x, next.y) == -1 || new_cost < costSoFar.get(next.x, next.y))
+            size_t currentIndex = tileIndex(current);
+            int32_t currentCost = mCostSoFar[currentIndex];
+            int32_t cameFrom = mCameFrom[currentIndex];
+
+            // Only the directions an optimal path could continue in from here need searching, the rest are covered from other tiles
+            std::pair<int32_t, int32_t> directions[8];
+            int32_t directionCount = 0;
+            auto addDirection = [&](int32_t dx, int32_t dy) { directions[directionCount++] = {dx, dy}; };
+
+            if (int32_t(currentIndex) == cameFrom)
+            {
+                for (int32_t dy = -1; dy <= 1; dy++)
                 {
-                    costSoFar.get(next.x, next.y) = new_cost;
-                    frontier.put(next, new_cost + heuristic(next, goal));
-                    came_from[next] = current;
+                    for (int32_t dx = -1; dx <= 1; dx++)
+                    {
+                        if (dx != 0 || dy != 0)
+                            addDirection(dx, dy);
+                    }
+                }
+            }
+            else
+            {
+                int32_t x = current.x;
+                int32_t y = current.y;
+                int32_t dx = sign(x - cameFrom % mWidth);
+                int32_t dy = sign(y - cameFrom / mWidth);
+
+                addDirection(dx, dy);
+                if (dx != 0 && dy != 0)
+                {
+                    addDirection(dx, 0);
+                    addDirection(0, dy);
+                    if (!walkable(level, actor, {x - dx, y}))
+                        addDirection(-dx, dy);
+                    if (!walkable(level, actor, {x, y - dy}))
+                        addDirection(dx, -dy);
+                }
+                else if (dx != 0)
+                {
+                    if (!walkable(level, actor, {x, y + 1}))
+                        addDirection(dx, 1);
+                    if (!walkable(level, actor, {x, y - 1}))
+                        addDirection(dx, -1);
+                }
+                else
+                {
+                    if (!walkable(level, actor, {x + 1, y}))
+                        addDirection(1, dy);
+                    if (!walkable(level, actor, {x - 1, y}))
+                        addDirection(-1, dy);
+                }
+            }
+
+            for (int32_t i = 0; i < directionCount; i++)
+            {
+                Misc::Point next;
+                if (!jump(level, actor, current, directions[i].first, directions[i].second, goal, stopAdjacent, next))
+                    continue;
+
+                // Jump points are always in a straight or diagonal line from where we jumped, so this is the exact cost
+                size_t nextIndex = tileIndex(next);
+                int32_t newCost = currentCost + int32_t(heuristic(current, next));
+
+                if (!visited(nextIndex) || newCost < mCostSoFar[nextIndex])
+                {
+                    mTileGeneration[nextIndex] = mGeneration;
+                    mCostSoFar[nextIndex] = newCost;
+                    mCameFrom[nextIndex] = int32_t(currentIndex);
+
+                    mOpen.push_back(OpenNode{newCost + heuristic(next, goal), next});
+                    std::push_heap(mOpen.begin(), mOpen.end(), openNodeGreater);
                 }
             }
         }
@@ -125,31 +305,48 @@ namespace FAWorld
         return false;
     }
 
-    Misc::Points reconstructPath(Misc::Point start, Misc::Point goal, std::unordered_map<Misc::Point, Misc::Point>& cameFrom)
+    Misc::Points PathFindContext::reconstructPath(Misc::Point start, Misc::Point goal) const
     {
         Misc::Points path;
         Misc::Point current = goal;
         path.push_back(current);
         while (current != start)
         {
-            current = cameFrom[current];
-            if (current != start)
-                path.push_back(current);
+            // Step towards the previous node a tile at a time, which fills in the line between jump points
+            int32_t cameFrom = mCameFrom[tileIndex(current)];
+            Misc::Point previous(cameFrom % mWidth, cameFrom / mWidth);
+            while (current != previous)
+            {
+                current = Misc::Point(current.x + sign(previous.x - current.x), current.y + sign(previous.y - current.y));
+                if (current != start)
+                    path.push_back(current);
+            }
         }
         path.push_back(start);
         std::reverse(path.begin(), path.end());
         return path;
     }
 
-    Misc::Points pathFind(GameLevelImpl* level, const Actor* actor, const Misc::Point& start, const Misc::Point& goal, bool& bArrivable, bool findAdjacent)
+    Misc::Points PathFindContext::pathFind(
+        GameLevelImpl* level, const Actor* actor, const Misc::Point& start, const Misc::Point& goal, bool& bArrivable, bool findAdjacent, PathFindMode mode)
     {
         auto adjustedGoal = goal;
-        std::unordered_map<Misc::Point, Misc::Point> cameFrom;
 
-        bArrivable = AStarSearch(level, actor, start, adjustedGoal, cameFrom, findAdjacent);
+        if (mode == PathFindMode::JumpPoint)
+            bArrivable = searchJumpPoints(level, actor, start, adjustedGoal, findAdjacent);
+        else
+            bArrivable = search(level, actor, start, adjustedGoal, findAdjacent);
+
         if (!bArrivable)
             return {};
 
-        return reconstructPath(start, adjustedGoal, cameFrom);
+        return reconstructPath(start, adjustedGoal);
+    }
+
+    Misc::Points
+    pathFind(GameLevelImpl* level, const Actor* actor, const Misc::Point& start, const Misc::Point& goal, bool& bArrivable, bool findAdjacent, PathFindMode mode)
+    {
+        thread_local PathFindContext context;
+        return context.pathFind(level, actor, start, goal, bArrivable, findAdjacent, mode);
     }
 }
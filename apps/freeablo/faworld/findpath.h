@@ -1,11 +1,86 @@
 #pragma once
+#include <cstdint>
 #include <misc/simplevec2.h>
+#include <vector>
 
 namespace FAWorld
 {
     class GameLevelImpl;
     class Actor;
 
+    enum class PathFindMode
+    {
+        AStar,
+        // Jump Point Search: finds a path of the same cost as AStar, but skips over the open tiles in between turns, so it expands far fewer nodes.
+        // Relies on every step costing the same apart from diagonals, which is true of all levels.
+        JumpPoint,
+    };
+
+    // Scratch space for A*, kept between searches so that once it has grown to fit the level, searching doesn't allocate (apart from the result).
+    // A context can only run one search at a time, so each thread needs its own, see pathFind().
+    class PathFindContext
+    {
+    public:
+        PathFindContext() = default;
+        PathFindContext(const PathFindContext&) = delete;
+        PathFindContext& operator=(const PathFindContext&) = delete;
+
+        Misc::Points pathFind(GameLevelImpl* level,
+                              const Actor* actor,
+                              const Misc::Point& start,
+                              const Misc::Point& goal,
+                              bool& bArrivable,
+                              bool findAdjacent,
+                              PathFindMode mode = PathFindMode::AStar);
+
+    private:
+        struct OpenNode
+        {
+            size_t priority;
+            Misc::Point point;
+        };
+
+        // Makes the heap a min-heap, ties are broken by position so the result doesn't depend on the order nodes were added in
+        static bool openNodeGreater(const OpenNode& a, const OpenNode& b)
+        {
+            return b.priority < a.priority || (b.priority == a.priority && b.point < a.point);
+        }
+
+        void startSearch(int32_t width, int32_t height);
+        bool search(GameLevelImpl* level, const Actor* actor, Misc::Point start, Misc::Point& goal, bool findAdjacent);
+        bool searchJumpPoints(GameLevelImpl* level, const Actor* actor, Misc::Point start, Misc::Point& goal, bool findAdjacent);
+        bool jump(GameLevelImpl* level, const Actor* actor, Misc::Point from, int32_t dx, int32_t dy, const Misc::Point& goal, bool stopAdjacent, Misc::Point& jumpPoint);
+        Misc::Points reconstructPath(Misc::Point start, Misc::Point goal) const;
+
+        size_t tileIndex(Misc::Point point) const { return size_t(point.y) * size_t(mWidth) + size_t(point.x); }
+        bool visited(size_t index) const { return mTileGeneration[index] == mGeneration; }
+
+        int32_t mWidth = 0;
+        int32_t mHeight = 0;
+
+        // Binary heap, maintained with std::push_heap() and std::pop_heap()
+        std::vector<OpenNode> mOpen;
+
+        // Indexed by tileIndex(). Instead of clearing these for every search, we bump mGeneration,
+        // and a tile's entries are only valid if its generation matches.
+        // For jump point search mCameFrom holds the previous jump point, which is in a straight or diagonal line from the tile
+        std::vector<int32_t> mCostSoFar;
+        std::vector<int32_t> mCameFrom;
+        std::vector<uint32_t> mTileGeneration;
+        uint32_t mGeneration = 0;
+
+        // Tiles jump() may still scan in the current jump point search
+        int32_t mJumpTilesLeft = 0;
+    };
+
     Misc::Points neighbors(GameLevelImpl* level, const Actor* actor, const Misc::Point& location);
-    Misc::Points pathFind(GameLevelImpl* level, const Actor* actor, const Misc::Point& start, const Misc::Point& goal, bool& bArrivable, bool findAdjacent);
+
+    // Searches with a context owned by the calling thread
+    Misc::Points pathFind(GameLevelImpl* level,
+                          const Actor* actor,
+                          const Misc::Point& start,
+                          const Misc::Point& goal,
+                          bool& bArrivable,
+                          bool findAdjacent,
+                          PathFindMode mode = PathFindMode::AStar);
 }
@@ -0,0 +1,91 @@
+#include "flowfield.h"
+#include "gamelevel.h"
+#include <algorithm>
+#include <functional>
+
+namespace
+{
+    const int32_t STRAIGHT_WEIGHT = 10;
+    const int32_t DIAGONAL_WEIGHT = 14;
+}
+
+namespace FAWorld
+{
+    void FlowField::build(const GameLevelImpl& level, Misc::Point source)
+    {
+        mSource = source;
+        mOrigin = Misc::Point(std::max(0, source.x - RADIUS), std::max(0, source.y - RADIUS));
+        mWidth = std::min(level.width(), source.x + RADIUS + 1) - mOrigin.x;
+        mHeight = std::min(level.height(), source.y + RADIUS + 1) - mOrigin.y;
+
+        mDistances.assign(size_t(mWidth) * size_t(mHeight), UNREACHABLE);
+        mOpen.clear();
+
+        // The source itself is usually occupied by whoever we're heading for, so it doesn't need to be passable
+        mDistances[localIndex(source)] = 0;
+        mOpen.push_back({0, localIndex(source)});
+
+        auto greater = std::greater<std::pair<int32_t, int32_t>>();
+        while (!mOpen.empty())
+        {
+            std::pop_heap(mOpen.begin(), mOpen.end(), greater);
+            auto [cost, index] = mOpen.back();
+            mOpen.pop_back();
+
+            if (cost > mDistances[index])
+                continue;
+
+            Misc::Point current(mOrigin.x + index % mWidth, mOrigin.y + index / mWidth);
+            for (int32_t dy = -1; dy <= 1; dy++)
+            {
+                for (int32_t dx = -1; dx <= 1; dx++)
+                {
+                    Misc::Point next(current.x + dx, current.y + dy);
+                    if ((dx == 0 && dy == 0) || !contains(next) || !level.isTerrainPassable(next))
+                        continue;
+
+                    int32_t nextIndex = localIndex(next);
+                    int32_t newCost = cost + (dx != 0 && dy != 0 ? DIAGONAL_WEIGHT : STRAIGHT_WEIGHT);
+                    if (newCost < mDistances[nextIndex])
+                    {
+                        mDistances[nextIndex] = newCost;
+                        mOpen.push_back({newCost, nextIndex});
+                        std::push_heap(mOpen.begin(), mOpen.end(), greater);
+                    }
+                }
+            }
+        }
+    }
+
+    int32_t FlowField::distance(Misc::Point point) const
+    {
+        if (!contains(point))
+            return UNREACHABLE;
+        return mDistances[localIndex(point)];
+    }
+
+    bool FlowField::nextStep(const GameLevelImpl& level, const Actor* actor, Misc::Point from, Misc::Point& next) const
+    {
+        int32_t best = distance(from);
+        if (best == UNREACHABLE)
+            return false;
+
+        bool found = false;
+        for (int32_t dy = -1; dy <= 1; dy++)
+        {
+            for (int32_t dx = -1; dx <= 1; dx++)
+            {
+                Misc::Point neighbour(from.x + dx, from.y + dy);
+                int32_t neighbourDistance = distance(neighbour);
+                if (neighbourDistance < best && level.isPassable(neighbour, actor))
+                {
+                    best = neighbourDistance;
+                    next = neighbour;
+                    found = true;
+                }
+            }
+        }
+
+        return found;
+    }
+}
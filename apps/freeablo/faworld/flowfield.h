@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <misc/simplevec2.h>
+#include <vector>
+
+namespace FAWorld
+{
+    class GameLevelImpl;
+    class Actor;
+
+    // Walking distance to a source tile from every tile within RADIUS of it, found with one Dijkstra search.
+    // Any number of actors heading for the source can then just walk downhill, instead of each searching for a path.
+    // Only the level geometry is considered when building the field, actors in the way are stepped around in nextStep().
+    class FlowField
+    {
+    public:
+        static constexpr int32_t RADIUS = 20;
+        static constexpr int32_t UNREACHABLE = std::numeric_limits<int32_t>::max();
+
+        void build(const GameLevelImpl& level, Misc::Point source);
+
+        Misc::Point getSource() const { return mSource; }
+        int32_t distance(Misc::Point point) const;
+
+        // The passable neighbour of from that is closest to the source, as long as it is closer than from is
+        bool nextStep(const GameLevelImpl& level, const Actor* actor, Misc::Point from, Misc::Point& next) const;
+
+    private:
+        int32_t localIndex(Misc::Point point) const { return (point.y - mOrigin.y) * mWidth + (point.x - mOrigin.x); }
+        bool contains(Misc::Point point) const
+        {
+            return point.x >= mOrigin.x && point.x < mOrigin.x + mWidth && point.y >= mOrigin.y && point.y < mOrigin.y + mHeight;
+        }
+
+        Misc::Point mSource;
+        Misc::Point mOrigin;
+        int32_t mWidth = 0;
+        int32_t mHeight = 0;
+        std::vector<int32_t> mDistances;
+        std::vector<std::pair<int32_t, int32_t>> mOpen;
+    };
+}
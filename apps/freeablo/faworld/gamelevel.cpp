@@ -2,19 +2,23 @@
 #include "../fasavegame/gameloader.h"
 #include "actor.h"
 #include "actorstats.h"
+#include "findpath.h"
 #include "itemmap.h"
 #include "missile/missile.h"
+#include "player.h"
 #include "world.h"
 #include <diabloexe/diabloexe.h>
 #include <engine/debugsettings.h>
 #include <misc/assert.h>
 #include <render/spritegroup.h>
+#include <serial/hashstream.h>
 
 namespace FAWorld
 {
     GameLevel::GameLevel(World& world, Level::Level&& level, size_t levelIndex)
         : mWorld(world), mLevel(std::move(level)), mLevelIndex(levelIndex), mItemMap(new ItemMap(this))
     {
+        mPathGraph.build(*this);
     }
 
     GameLevel::GameLevel(World& world, FASaveGame::GameLoader& loader)
@@ -28,7 +32,7 @@ namespace FAWorld
         mActors.reserve(actorsSize);
         for (uint32_t i = 0; i < actorsSize; i++)
         {
-            std::string actorTypeId = loader.load<std::string>();
+            FASaveGame::TypeId actorTypeId = FASaveGame::TypeId(loader.load<uint8_t>());
             Actor* actor = static_cast<Actor*>(mWorld.mObjectIdMapper.construct(actorTypeId, loader));
             mActors.push_back(actor);
         }
@@ -37,6 +41,7 @@ namespace FAWorld
         loader.currentlyLoadingLevel = nullptr;
 
         actorMapRefresh();
+        mPathGraph.build(*this);
     }
 
     void GameLevel::save(FASaveGame::GameSaver& saver) const
@@ -52,11 +57,29 @@ namespace FAWorld
 
         for (Actor* actor : mActors)
         {
-            saver.save(actor->getTypeId());
+            saver.save(uint8_t(actor->getTypeId()));
             actor->save(saver);
         }
     }
 
+    uint64_t GameLevel::getChecksum() const
+    {
+        Serial::HashWriteStream stream;
+        FASaveGame::GameSaver saver(stream);
+
+        saver.save(mLevelIndex);
+        mItemMap->save(saver);
+
+        saver.save(uint32_t(mActors.size()));
+        for (Actor* actor : mActors)
+        {
+            saver.save(uint8_t(actor->getTypeId()));
+            actor->save(saver);
+        }
+
+        return stream.getHash();
+    }
+
     GameLevel::~GameLevel()
     {
         for (size_t i = 0; i < mActors.size(); i++)
@@ -91,6 +114,14 @@ namespace FAWorld
 
         bool retval = mLevel.activateDoor(point);
 
+        // Doors change passability for the whole dungeon square they're in, which covers the tiles next to point
+        if (retval)
+        {
+            mPathGraph.rebuildArea(*this, Misc::Point(point.x - 1, point.y - 1), Misc::Point(point.x + 1, point.y + 1));
+            mPathCache.invalidate();
+            mFlowFields.clear();
+        }
+
 #ifndef NDEBUG
         for (const auto& actor : mActors)
         {
@@ -113,6 +144,10 @@ namespace FAWorld
 
     void GameLevel::update(bool noclip)
     {
+        // Levels are only updated while a player is on them, and all changes to a level happen during an update,
+        // except for actors arriving and leaving, which are handled in insertActor and removeActor.
+        mDirty = true;
+
         for (auto& actor : mActors)
             actor->update(noclip);
 
@@ -162,6 +197,7 @@ namespace FAWorld
             mActors.push_back(actor);
 
         actorMapInsert(actor);
+        mDirty = true;
     }
 
     void GameLevel::actorMapInsert(Actor* actor)
@@ -248,6 +284,53 @@ namespace FAWorld
         return actor == nullptr || actor == forActor;
     }
 
+    bool GameLevel::isTerrainPassable(const Misc::Point& point) const
+    {
+        return point.x >= 0 && point.x < width() && point.y >= 0 && point.y < height() && mLevel.get(point).passable();
+    }
+
+    Misc::Points GameLevel::findPath(const Actor* actor, const Misc::Point& start, const Misc::Point& goal, bool findAdjacent, bool& bComplete)
+    {
+        bool bArrivable = false;
+
+        PathCache::Result waypoint;
+        if (!mPathCache.lookup(start, goal, waypoint))
+        {
+            waypoint.found = mPathGraph.findNextWaypoint(*this, start, goal, waypoint.waypoint);
+            mPathCache.store(start, goal, waypoint);
+        }
+
+        if (waypoint.found)
+        {
+            Misc::Points segment = pathFind(this, actor, start, waypoint.waypoint, bArrivable, false, PathFindMode::JumpPoint);
+
+            // If an actor is standing on the waypoint we can end up stuck next to it, so then fall back to searching the whole way
+            if (segment.size() > 1 && segment.back() != start)
+            {
+                bComplete = false;
+                return segment;
+            }
+        }
+
+        bComplete = true;
+        return pathFind(this, actor, start, goal, bArrivable, findAdjacent, PathFindMode::JumpPoint);
+    }
+
+    bool GameLevel::findFlowFieldStep(const Actor* actor, const Misc::Point& destination, Misc::Point& next)
+    {
+        const Player* player = dynamic_cast<const Player*>(getActorAt(destination));
+        if (!player || player == actor)
+            return false;
+
+        Misc::Point source = player->getPos().current();
+        auto [it, inserted] = mFlowFields.try_emplace(player->getId());
+        FlowField& field = it->second;
+        if (inserted || field.getSource() != source)
+            field.build(*this, source);
+
+        return field.nextStep(*this, actor, actor->getPos().current(), next);
+    }
+
     Actor* GameLevel::getActorAt(const Misc::Point& point) const
     {
         auto it = mActorMap2D.find(point);
@@ -315,6 +398,8 @@ namespace FAWorld
                 mActors.erase(i);
                 actorMapRemove(actor, actor->getPos().current());
                 actorMapRemove(actor, actor->getPos().next());
+                mFlowFields.erase(actor->getId());
+                mDirty = true;
                 return;
             }
         }
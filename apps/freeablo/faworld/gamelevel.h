@@ -1,6 +1,9 @@
 #pragma once
 #include "hoverstate.h"
 #include "itemmap.h" // TODO: remove, only included for the Tile type
+#include "flowfield.h"
+#include "pathcache.h"
+#include "pathgraph.h"
 #include <faworld/item/item.h>
 #include <functional>
 #include <level/level.h>
@@ -46,6 +49,9 @@ namespace FAWorld
         virtual int32_t height() const = 0;
 
         virtual bool isPassable(const Misc::Point& point, const FAWorld::Actor* forActor) const = 0;
+
+        // Passability of the level geometry alone, ignoring actors
+        virtual bool isTerrainPassable(const Misc::Point& point) const = 0;
     };
 
     class GameLevel : public GameLevelImpl
@@ -57,6 +63,10 @@ namespace FAWorld
 
         void save(FASaveGame::GameSaver& gameSaver) const;
 
+        // Hash of the state that changes as the game runs (items and actors), used by multiplayer games to detect desyncs.
+        // The level geometry is left out, as it's expensive to hash every tick and only ever changes when an actor opens a door.
+        uint64_t getChecksum() const;
+
         ~GameLevel();
 
         Level::MinPillar getTile(const Misc::Point& point) const;
@@ -93,6 +103,17 @@ namespace FAWorld
                                     const std::function<bool(const Misc::Point& point)>& additionalConstraints = nullptr) const;
 
         virtual bool isPassable(const Misc::Point& point, const FAWorld::Actor* forActor) const;
+        virtual bool isTerrainPassable(const Misc::Point& point) const;
+
+        // Finds a path for actor, using the level's PathGraph for long paths. Those only get their first segment (up to an entrance
+        // of the next cluster along) searched tile by tile, in which case bComplete is set to false and the caller should find the
+        // path again from the end of the segment.
+        Misc::Points findPath(const Actor* actor, const Misc::Point& start, const Misc::Point& goal, bool findAdjacent, bool& bComplete);
+
+        // If there is a player (other than actor) at destination, the next step for actor on the way to them, using a flow field
+        // shared by everyone heading for that player. The field is built from scratch whenever the player changes tile or a door changes,
+        // so it depends only on the current state of the level, and doesn't need to be saved.
+        bool findFlowFieldStep(const Actor* actor, const Misc::Point& destination, Misc::Point& next);
 
         Actor* getActorAt(const Misc::Point& point) const;
 
@@ -102,6 +123,12 @@ namespace FAWorld
 
         int32_t getLevelIndex() const { return mLevelIndex; }
 
+        // Cleared by the autosave journal once it has saved the level. This is conservative: it is set by every update(), so it really means
+        // "a player has been on this level since it was last saved", rather than that something in the level actually changed.
+        // Levels nobody is on are never updated, so they are still only saved once.
+        bool isDirty() const { return mDirty; }
+        void clearDirty() { mDirty = false; }
+
         bool dropItem(std::unique_ptr<Item>& item, const Actor& actor, Misc::Point tile);
         bool dropItemClosestEmptyTile(std::unique_ptr<Item>& item, const Actor& actor, const Misc::Point& position, Misc::Direction direction);
 
@@ -132,5 +159,11 @@ namespace FAWorld
         friend class FARender::Renderer;
 
         std::unique_ptr<ItemMap> mItemMap;
+
+        PathGraph mPathGraph; ///< not serialised, rebuilt from the level
+        PathCache mPathCache; ///< not serialised
+        std::unordered_map<int32_t, FlowField> mFlowFields; ///< by player id, not serialised
+
+        bool mDirty = true; ///< not serialised
     };
 }
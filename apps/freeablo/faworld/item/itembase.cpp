@@ -11,7 +11,7 @@ namespace FAWorld
           mSize(exeItem.invSizeX, exeItem.invSizeY), mPrice(exeItem.price), mQualityLevel(exeItem.qualityLevel), mDropRate(exeItem.dropRate),
           mDropItemSoundPath(exeItem.dropItemSoundPath), mInventoryPlaceItemSoundPath(exeItem.invPlaceItemSoundPath)
     {
-        FARender::SpriteLoader& spriteLoader = FARender::Renderer::get()->mSpriteLoader;
+        FARender::SpriteLoader& spriteLoader = *FARender::SpriteLoader::get();
         mDropItemAnimation = spriteLoader.getSprite(spriteLoader.mItemDrops[mId]);
 
         Render::SpriteGroup* itemIcons = spriteLoader.getSprite(spriteLoader.mGuiSprites.itemCursors);
@@ -21,10 +21,15 @@ namespace FAWorld
         if (itemIconFrame >= 0 && itemIconFrame < itemIcons->size())
         {
             mInventoryIcon = itemIcons->getFrame(itemIconFrame);
-            static std::vector<Image> itemCursorImages = Cel::CelDecoder(spriteLoader.mGuiSprites.itemCursors.path).decode();
 
-            const Image& cursorImage = itemCursorImages[itemIconFrame];
-            mInventoryIconCursor = std::make_unique<Render::Cursor>(cursorImage, cursorImage.width() / 2, cursorImage.height() / 2);
+            // cursors are only used by the gui, so don't bother decoding them when running headless
+            if (FARender::Renderer::get())
+            {
+                static std::vector<Image> itemCursorImages = Cel::CelDecoder(spriteLoader.mGuiSprites.itemCursors.path).decode();
+
+                const Image& cursorImage = itemCursorImages[itemIconFrame];
+                mInventoryIconCursor = std::make_unique<Render::Cursor>(cursorImage, cursorImage.width() / 2, cursorImage.height() / 2);
+            }
         }
     }
 
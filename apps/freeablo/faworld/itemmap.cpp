@@ -75,11 +75,20 @@ namespace FAWorld
         if (!mLevel->isPassable(tile, &actor))
             return false;
 
+        std::string soundPath = item->getBase()->mDropItemSoundPath;
+        if (!placeItem(item, tile))
+            return false;
+
+        Engine::ThreadManager::get()->playSound(soundPath);
+        return true;
+    }
+
+    bool ItemMap::placeItem(std::unique_ptr<Item>& item, Misc::Point tile)
+    {
         auto it = mItems.find(tile);
         if (it != mItems.end())
             return false;
 
-        Engine::ThreadManager::get()->playSound(item->getBase()->mDropItemSoundPath);
         mItems.emplace(tile, PlacedItemData{std::move(item), tile});
         return true;
     }
@@ -63,6 +63,8 @@ namespace FAWorld
 
         ~ItemMap();
         bool dropItem(std::unique_ptr<FAWorld::Item>& item, const Actor& actor, Misc::Point tile);
+        // Like dropItem, but without the passability check or drop sound, for placing items during level setup
+        bool placeItem(std::unique_ptr<FAWorld::Item>& item, Misc::Point tile);
         PlacedItemData* getItemAt(Misc::Point pos);
         std::unique_ptr<FAWorld::Item> takeItemAt(Misc::Point tile);
 
@@ -70,7 +70,7 @@ namespace FAWorld::Missile
 
     const FARender::SpriteLoader::SpriteDefinition& Missile::getGraphic(int32_t i) const
     {
-        FARender::SpriteLoader& spriteLoader = FARender::Renderer::get()->mSpriteLoader;
+        FARender::SpriteLoader& spriteLoader = *FARender::SpriteLoader::get();
 
         const std::vector<FARender::SpriteLoader::SpriteDefinition>& directions = spriteLoader.mMissileAnimations[missileData().mMissileGraphicsId];
         release_assert(i >= 0 && i < int32_t(directions.size()));
@@ -14,8 +14,6 @@
 
 namespace FAWorld
 {
-    const std::string Monster::typeId = "monster";
-
     Monster::Monster(World& world, const DiabloExe::Monster& monsterData) : Actor(world)
     {
         mStats.initialise(BaseStats());
@@ -152,7 +150,7 @@ namespace FAWorld
 
     void Monster::restoreAnimations()
     {
-        FARender::SpriteLoader& spriteLoader = FARender::Renderer::get()->mSpriteLoader;
+        FARender::SpriteLoader& spriteLoader = *FARender::SpriteLoader::get();
         FARender::SpriteLoader::MonsterSpriteDefinition spriteDefinitions = spriteLoader.mMonsterSpriteDefinitions[mMonsterId];
 
         mAnimation.setAnimationSprites(AnimState::walk, spriteLoader.getSprite(spriteDefinitions.walk));
@@ -8,8 +8,8 @@ namespace FAWorld
         using super = Actor;
 
     public:
-        static const std::string typeId;
-        const std::string& getTypeId() override { return typeId; }
+        static constexpr FASaveGame::TypeId typeId = FASaveGame::TypeId::monster;
+        FASaveGame::TypeId getTypeId() override { return typeId; }
 
         Monster(World& world, const DiabloExe::Monster& monsterStats);
         Monster(World& world, FASaveGame::GameLoader& loader);
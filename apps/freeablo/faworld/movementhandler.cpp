@@ -1,7 +1,7 @@
 #include "movementhandler.h"
 #include "../fasavegame/gameloader.h"
 #include "actor.h"
-#include "findpath.h"
+#include "behaviour.h"
 
 namespace FAWorld
 {
@@ -25,6 +25,8 @@ namespace FAWorld
         {
             mCurrentPath.emplace_back(Misc::Point(loader));
         }
+        mCurrentPathComplete = loader.load<bool>();
+        mCurrentPathDestination = Misc::Point(loader);
 
         mLastRepathed = loader.load<Tick>();
         mPathRateLimit = loader.load<Tick>();
@@ -52,6 +54,8 @@ namespace FAWorld
         {
             item.save(saver);
         }
+        saver.save(mCurrentPathComplete);
+        mCurrentPathDestination.save(saver);
 
         saver.save(mLastRepathed);
         saver.save(mPathRateLimit);
@@ -91,11 +95,26 @@ namespace FAWorld
         if (!mCurrentPos.isMoving())
         {
             // if we have arrived, stop moving
+            Misc::Point flowFieldStep;
+
             if (mCurrentPos.current() == mDestination)
             {
                 mCurrentPath.clear();
                 mCurrentPathIndex = 0;
             }
+            // Monsters chasing a player walk down the player's flow field, rather than each searching for their own path
+            else if (actor.getBehaviour() && actor.getBehaviour()->getTypeId() == BasicMonsterBehaviour::typeId &&
+                     mLevel->findFlowFieldStep(&actor, mDestination, flowFieldStep))
+            {
+                mCurrentPath.clear();
+                mCurrentPathIndex = 0;
+
+                Vec2Fix vec = Vec2Fix(flowFieldStep.x, flowFieldStep.y) - Vec2Fix(mCurrentPos.current().x, mCurrentPos.current().y);
+                Misc::Direction8 direction = vec.getDirection().getDirection8();
+                debug_assert(flowFieldStep == Misc::getNextPosByDir(mCurrentPos.current(), direction));
+
+                mCurrentPos.gridMoveInDirection(direction);
+            }
             else
             {
                 bool needsRepath = true;
@@ -104,6 +123,10 @@ namespace FAWorld
                 int32_t modNum = 3;
                 canRepath = canRepath && ((mLevel->getWorld()->getCurrentTick() % modNum) == (actor.getId() % modNum));
 
+                // Long paths are found one segment at a time, so carry straight on with the next one when we reach the end of a segment
+                bool finishedSegment = !mCurrentPath.empty() && !mCurrentPathComplete && mCurrentPos.current() == mCurrentPath.back();
+                canRepath = canRepath || (finishedSegment && mLastRepathed != mLevel->getWorld()->getCurrentTick());
+
                 if (!mCurrentPath.empty())
                 {
                     // detect if we were blocked on our way and try to recover
@@ -124,8 +147,11 @@ namespace FAWorld
                     // try to continue with our path
                     else if (mCurrentPathIndex < int32_t(mCurrentPath.size()) - 1)
                     {
-                        // If our destination hasn't changed, or we can't repath, keep moving along our current path
-                        if (mCurrentPath.back() == mDestination || !canRepath)
+                        // If our destination hasn't changed, or we can't repath, keep moving along our current path.
+                        // A segment of a long path ends at a waypoint, so for those we compare with the destination it was found for.
+                        bool destinationUnchanged =
+                            mCurrentPathComplete ? mCurrentPath.back() == mDestination : mCurrentPathDestination == mDestination;
+                        if (destinationUnchanged || !canRepath)
                         {
                             auto next = mCurrentPath[mCurrentPathIndex + 1];
 
@@ -153,8 +179,8 @@ namespace FAWorld
                 {
                     mLastRepathed = mLevel->getWorld()->getCurrentTick();
 
-                    bool _;
-                    mCurrentPath = pathFind(mLevel, &actor, mCurrentPos.current(), mDestination, _, mAdjacent);
+                    mCurrentPathDestination = mDestination;
+                    mCurrentPath = mLevel->findPath(&actor, mCurrentPos.current(), mDestination, mAdjacent, mCurrentPathComplete);
                     mCurrentPathIndex = 1;
 
                     if (mCurrentPath.size() <= 1)
@@ -163,7 +189,7 @@ namespace FAWorld
                         mCurrentPathIndex = 0;
                     }
 
-                    if (!mCurrentPath.empty())
+                    if (!mCurrentPath.empty() && mCurrentPathComplete)
                         mDestination = mCurrentPath.back();
 
                     return moveDistance; // By returning the full amount we will force the function to start again
@@ -45,6 +45,8 @@ namespace FAWorld
 
         int32_t mCurrentPathIndex = 0;
         Misc::Points mCurrentPath;
+        bool mCurrentPathComplete = true; ///< false when mCurrentPath is only the first segment of a long path, see GameLevel::findPath()
+        Misc::Point mCurrentPathDestination; ///< mDestination when mCurrentPath was found
         Tick mLastRepathed = std::numeric_limits<Tick>::min();
         bool mAdjacent = false;
     };
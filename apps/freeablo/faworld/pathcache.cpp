@@ -0,0 +1,29 @@
+#include "pathcache.h"
+
+namespace FAWorld
+{
+    size_t PathCache::slot(Misc::Point start, Misc::Point goal)
+    {
+        uint32_t hash = uint32_t(start.x) * 73856093u ^ uint32_t(start.y) * 19349663u ^ uint32_t(goal.x) * 83492791u ^ uint32_t(goal.y) * 2654435761u;
+        return (hash ^ (hash >> 16)) % SIZE;
+    }
+
+    bool PathCache::lookup(Misc::Point start, Misc::Point goal, Result& result) const
+    {
+        const Entry& entry = mEntries[slot(start, goal)];
+        if (entry.epoch != mEpoch || entry.start != start || entry.goal != goal)
+            return false;
+
+        result = entry.result;
+        return true;
+    }
+
+    void PathCache::store(Misc::Point start, Misc::Point goal, const Result& result)
+    {
+        Entry& entry = mEntries[slot(start, goal)];
+        entry.start = start;
+        entry.goal = goal;
+        entry.epoch = mEpoch;
+        entry.result = result;
+    }
+}
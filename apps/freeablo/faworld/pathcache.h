@@ -0,0 +1,45 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <misc/simplevec2.h>
+
+namespace FAWorld
+{
+    // Remembers recent PathGraph waypoint lookups by start and goal tile, so actors heading the same way from the same place
+    // don't repeat the search. Entries are tagged with a passability epoch, which the level bumps whenever passability changes,
+    // so a stale entry is never returned. Results only depend on the level geometry, so a hit is exactly what a fresh
+    // search would have found, and peers with different cache contents (e.g. one that just joined) still agree.
+    class PathCache
+    {
+    public:
+        static constexpr size_t SIZE = 256;
+
+        struct Result
+        {
+            bool found = false;
+            Misc::Point waypoint;
+        };
+
+        void invalidate() { mEpoch++; }
+        uint32_t getEpoch() const { return mEpoch; }
+
+        bool lookup(Misc::Point start, Misc::Point goal, Result& result) const;
+
+        // Replaces whatever was in the slot for start and goal
+        void store(Misc::Point start, Misc::Point goal, const Result& result);
+
+    private:
+        struct Entry
+        {
+            Misc::Point start;
+            Misc::Point goal;
+            uint32_t epoch = 0;
+            Result result;
+        };
+
+        static size_t slot(Misc::Point start, Misc::Point goal);
+
+        std::array<Entry, SIZE> mEntries;
+        uint32_t mEpoch = 1; ///< starts above the default entry epoch, so empty entries never match
+    };
+}
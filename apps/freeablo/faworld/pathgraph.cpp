@@ -0,0 +1,335 @@
+#include "pathgraph.h"
+#include "gamelevel.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+namespace
+{
+    const int32_t STRAIGHT_WEIGHT = 10;
+    const int32_t DIAGONAL_WEIGHT = 14;
+
+    const int32_t UNREACHABLE = std::numeric_limits<int32_t>::max();
+
+    // Short entrances get one node in the middle, longer ones get a node at each end, so paths along the border don't have to detour
+    const int32_t SPLIT_ENTRANCE_LENGTH = 6;
+
+    int32_t octileDistance(Misc::Point a, Misc::Point b)
+    {
+        int32_t dx = std::abs(b.x - a.x);
+        int32_t dy = std::abs(b.y - a.y);
+        return std::min(dx, dy) * DIAGONAL_WEIGHT + std::abs(dx - dy) * STRAIGHT_WEIGHT;
+    }
+}
+
+namespace FAWorld
+{
+    void PathGraph::build(const GameLevelImpl& level)
+    {
+        mWidth = level.width();
+        mHeight = level.height();
+        mClustersWide = (mWidth + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+        mClustersHigh = (mHeight + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+
+        mClusters.clear();
+        mClusters.resize(size_t(mClustersWide) * size_t(mClustersHigh));
+
+        for (int32_t y = 0; y < mClustersHigh; y++)
+        {
+            for (int32_t x = 0; x < mClustersWide; x++)
+            {
+                Cluster& cluster = mClusters[y * mClustersWide + x];
+                cluster.origin = Misc::Point(x * CLUSTER_SIZE, y * CLUSTER_SIZE);
+                cluster.width = std::min(CLUSTER_SIZE, mWidth - cluster.origin.x);
+                cluster.height = std::min(CLUSTER_SIZE, mHeight - cluster.origin.y);
+            }
+        }
+
+        rebuildArea(level, Misc::Point(0, 0), Misc::Point(mWidth - 1, mHeight - 1));
+    }
+
+    void PathGraph::rebuildArea(const GameLevelImpl& level, Misc::Point topLeft, Misc::Point bottomRight)
+    {
+        if (mClusters.empty())
+            return;
+
+        // Entrances are made of tile pairs that straddle a border, so a change right next to a border affects the cluster across it too
+        int32_t minX = std::max(0, topLeft.x - 1) / CLUSTER_SIZE;
+        int32_t minY = std::max(0, topLeft.y - 1) / CLUSTER_SIZE;
+        int32_t maxX = std::min(mWidth - 1, bottomRight.x + 1) / CLUSTER_SIZE;
+        int32_t maxY = std::min(mHeight - 1, bottomRight.y + 1) / CLUSTER_SIZE;
+
+        for (int32_t y = minY; y <= maxY; y++)
+        {
+            for (int32_t x = minX; x <= maxX; x++)
+                buildCluster(level, y * mClustersWide + x);
+        }
+
+        mNodeOffsets.resize(mClusters.size());
+        mNodeCount = 0;
+        mNodeTiles.clear();
+        for (size_t i = 0; i < mClusters.size(); i++)
+        {
+            mNodeOffsets[i] = mNodeCount;
+            mNodeCount += int32_t(mClusters[i].nodes.size());
+
+            for (const Node& node : mClusters[i].nodes)
+                mNodeTiles.push_back(node.tile);
+        }
+    }
+
+    void PathGraph::buildCluster(const GameLevelImpl& level, int32_t index)
+    {
+        Cluster& cluster = mClusters[index];
+        cluster.nodes.clear();
+
+        Misc::Point origin = cluster.origin;
+        Misc::Point farCorner(origin.x + cluster.width - 1, origin.y + cluster.height - 1);
+
+        if (origin.x > 0)
+            addEntrances(level, cluster, origin, Misc::Point(0, 1), Misc::Point(-1, 0));
+        if (farCorner.x < mWidth - 1)
+            addEntrances(level, cluster, Misc::Point(farCorner.x, origin.y), Misc::Point(0, 1), Misc::Point(1, 0));
+        if (origin.y > 0)
+            addEntrances(level, cluster, origin, Misc::Point(1, 0), Misc::Point(0, -1));
+        if (farCorner.y < mHeight - 1)
+            addEntrances(level, cluster, Misc::Point(origin.x, farCorner.y), Misc::Point(1, 0), Misc::Point(0, 1));
+
+        for (Node& node : cluster.nodes)
+        {
+            clusterDistances(level, cluster, node.tile);
+
+            for (int32_t i = 0; i < int32_t(cluster.nodes.size()); i++)
+            {
+                int32_t cost = clusterDistance(cluster, cluster.nodes[i].tile);
+                if (&cluster.nodes[i] != &node && cost != UNREACHABLE)
+                    node.edges.push_back(Edge{i, cost});
+            }
+        }
+    }
+
+    void PathGraph::addEntrances(const GameLevelImpl& level, Cluster& cluster, Misc::Point borderStart, Misc::Point step, Misc::Point across)
+    {
+        int32_t length = step.x != 0 ? cluster.width : cluster.height;
+
+        // Both clusters scan the same border in the same order, so they agree on where the nodes go
+        int32_t runStart = -1;
+        for (int32_t i = 0; i <= length; i++)
+        {
+            Misc::Point tile = borderStart + step * i;
+            bool open = i < length && level.isTerrainPassable(tile) && level.isTerrainPassable(tile + across);
+
+            if (open && runStart == -1)
+                runStart = i;
+
+            if (!open && runStart != -1)
+            {
+                int32_t runLength = i - runStart;
+                if (runLength < SPLIT_ENTRANCE_LENGTH)
+                {
+                    Misc::Point middle = borderStart + step * (runStart + runLength / 2);
+                    addNode(cluster, middle, middle + across);
+                }
+                else
+                {
+                    Misc::Point first = borderStart + step * runStart;
+                    Misc::Point last = borderStart + step * (i - 1);
+                    addNode(cluster, first, first + across);
+                    addNode(cluster, last, last + across);
+                }
+
+                runStart = -1;
+            }
+        }
+    }
+
+    void PathGraph::addNode(Cluster& cluster, Misc::Point tile, Misc::Point partner)
+    {
+        // Corner tiles can be entrances on two borders
+        for (Node& node : cluster.nodes)
+        {
+            if (node.tile == tile)
+            {
+                node.partners.push_back(partner);
+                return;
+            }
+        }
+
+        cluster.nodes.push_back(Node{tile, {partner}, {}});
+    }
+
+    void PathGraph::clusterDistances(const GameLevelImpl& level, const Cluster& cluster, Misc::Point source)
+    {
+        mDistances.assign(size_t(cluster.width) * size_t(cluster.height), UNREACHABLE);
+        mDistanceOpen.clear();
+
+        // The source is allowed to be unpassable, so we can measure the distance to a goal that is a wall or door
+        auto localIndex = [&](Misc::Point tile) { return (tile.y - cluster.origin.y) * cluster.width + (tile.x - cluster.origin.x); };
+        mDistances[localIndex(source)] = 0;
+        mDistanceOpen.push_back({0, localIndex(source)});
+
+        auto greater = std::greater<std::pair<int32_t, int32_t>>();
+        while (!mDistanceOpen.empty())
+        {
+            std::pop_heap(mDistanceOpen.begin(), mDistanceOpen.end(), greater);
+            auto [cost, index] = mDistanceOpen.back();
+            mDistanceOpen.pop_back();
+
+            if (cost > mDistances[index])
+                continue;
+
+            Misc::Point current(cluster.origin.x + index % cluster.width, cluster.origin.y + index / cluster.width);
+            for (int32_t dy = -1; dy <= 1; dy++)
+            {
+                for (int32_t dx = -1; dx <= 1; dx++)
+                {
+                    Misc::Point next(current.x + dx, current.y + dy);
+                    if ((dx == 0 && dy == 0) || next.x < cluster.origin.x || next.x >= cluster.origin.x + cluster.width || next.y < cluster.origin.y ||
+                        next.y >= cluster.origin.y + cluster.height || !level.isTerrainPassable(next))
+                        continue;
+
+                    int32_t nextIndex = localIndex(next);
+                    int32_t newCost = cost + (dx != 0 && dy != 0 ? DIAGONAL_WEIGHT : STRAIGHT_WEIGHT);
+                    if (newCost < mDistances[nextIndex])
+                    {
+                        mDistances[nextIndex] = newCost;
+                        mDistanceOpen.push_back({newCost, nextIndex});
+                        std::push_heap(mDistanceOpen.begin(), mDistanceOpen.end(), greater);
+                    }
+                }
+            }
+        }
+    }
+
+    int32_t PathGraph::clusterDistance(const Cluster& cluster, Misc::Point tile) const
+    {
+        return mDistances[(tile.y - cluster.origin.y) * cluster.width + (tile.x - cluster.origin.x)];
+    }
+
+    bool PathGraph::abstractSearch(const GameLevelImpl& level, Misc::Point start, Misc::Point goal)
+    {
+        int32_t startCluster = clusterIndex(start);
+        int32_t goalCluster = clusterIndex(goal);
+        int32_t startId = mNodeCount;
+        int32_t goalId = mNodeCount + 1;
+
+        // Connect the start and goal to the entrances of their clusters (and to each other, if they share one)
+        clusterDistances(level, mClusters[goalCluster], goal);
+        mGoalCosts.clear();
+        for (const Node& node : mClusters[goalCluster].nodes)
+            mGoalCosts.push_back(clusterDistance(mClusters[goalCluster], node.tile));
+        int32_t startToGoalCost = startCluster == goalCluster ? clusterDistance(mClusters[goalCluster], start) : UNREACHABLE;
+
+        clusterDistances(level, mClusters[startCluster], start);
+        mStartCosts.clear();
+        for (const Node& node : mClusters[startCluster].nodes)
+            mStartCosts.push_back(clusterDistance(mClusters[startCluster], node.tile));
+
+        mNodeTiles.resize(mNodeCount + 2);
+        mNodeTiles[startId] = start;
+        mNodeTiles[goalId] = goal;
+
+        mCostSoFar.assign(mNodeCount + 2, UNREACHABLE);
+        mCameFrom.assign(mNodeCount + 2, -1);
+        mOpen.clear();
+
+        // Min-heap, ties broken by id so the result doesn't depend on the order nodes were added in
+        auto openNodeGreater = [](const OpenNode& a, const OpenNode& b) { return b.priority < a.priority || (b.priority == a.priority && b.id < a.id); };
+
+        auto relax = [&](int32_t from, int32_t to, int32_t cost) {
+            if (cost != UNREACHABLE && mCostSoFar[from] + cost < mCostSoFar[to])
+            {
+                mCostSoFar[to] = mCostSoFar[from] + cost;
+                mCameFrom[to] = from;
+                mOpen.push_back(OpenNode{mCostSoFar[to] + octileDistance(mNodeTiles[to], goal), to});
+                std::push_heap(mOpen.begin(), mOpen.end(), openNodeGreater);
+            }
+        };
+
+        mCostSoFar[startId] = 0;
+        mCameFrom[startId] = startId;
+        mOpen.push_back(OpenNode{0, startId});
+
+        while (!mOpen.empty())
+        {
+            std::pop_heap(mOpen.begin(), mOpen.end(), openNodeGreater);
+            OpenNode current = mOpen.back();
+            mOpen.pop_back();
+
+            if (current.id == goalId)
+                return true;
+            if (current.priority > mCostSoFar[current.id] + octileDistance(mNodeTiles[current.id], goal))
+                continue;
+
+            if (current.id == startId)
+            {
+                for (int32_t i = 0; i < int32_t(mStartCosts.size()); i++)
+                    relax(startId, nodeId(startCluster, i), mStartCosts[i]);
+                relax(startId, goalId, startToGoalCost);
+                continue;
+            }
+
+            // Clusters with no nodes share an offset with the next one, so take the last cluster starting at or before this id
+            int32_t nodeCluster = int32_t(std::upper_bound(mNodeOffsets.begin(), mNodeOffsets.end(), current.id) - mNodeOffsets.begin()) - 1;
+            const Node& node = mClusters[nodeCluster].nodes[current.id - mNodeOffsets[nodeCluster]];
+
+            for (const Edge& edge : node.edges)
+                relax(current.id, nodeId(nodeCluster, edge.to), edge.cost);
+
+            for (Misc::Point partner : node.partners)
+            {
+                int32_t partnerCluster = clusterIndex(partner);
+                const auto& partnerNodes = mClusters[partnerCluster].nodes;
+                for (int32_t i = 0; i < int32_t(partnerNodes.size()); i++)
+                {
+                    if (partnerNodes[i].tile == partner)
+                        relax(current.id, nodeId(partnerCluster, i), STRAIGHT_WEIGHT);
+                }
+            }
+
+            if (nodeCluster == goalCluster)
+                relax(current.id, goalId, mGoalCosts[current.id - mNodeOffsets[nodeCluster]]);
+        }
+
+        return false;
+    }
+
+    Misc::Points PathGraph::findAbstractPath(const GameLevelImpl& level, Misc::Point start, Misc::Point goal)
+    {
+        if (!inBounds(start) || !inBounds(goal) || !abstractSearch(level, start, goal))
+            return {};
+
+        Misc::Points path;
+        for (int32_t id = mNodeCount + 1; id != mNodeCount; id = mCameFrom[id])
+        {
+            if (mNodeTiles[id] != start && (path.empty() || path.back() != mNodeTiles[id]))
+                path.push_back(mNodeTiles[id]);
+        }
+
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+    bool PathGraph::findNextWaypoint(const GameLevelImpl& level, Misc::Point start, Misc::Point goal, Misc::Point& waypoint)
+    {
+        if (!inBounds(start) || !inBounds(goal))
+            return false;
+
+        int32_t startCluster = clusterIndex(start);
+        if (startCluster == clusterIndex(goal) || !abstractSearch(level, start, goal))
+            return false;
+
+        // Walking back from the goal, the last node we see outside the start cluster is the first one the path reaches
+        bool found = false;
+        for (int32_t id = mNodeCount + 1; id != mNodeCount; id = mCameFrom[id])
+        {
+            if (clusterIndex(mNodeTiles[id]) != startCluster)
+            {
+                waypoint = mNodeTiles[id];
+                found = true;
+            }
+        }
+
+        return found;
+    }
+}
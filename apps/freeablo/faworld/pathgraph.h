@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <misc/simplevec2.h>
+#include <vector>
+
+namespace FAWorld
+{
+    class GameLevelImpl;
+
+    // Hierarchical path graph over a level (HPA*). The level is split into square clusters, and the places where paths can cross
+    // from one cluster to the next (entrances) become the nodes of a much smaller graph, with the walking cost between each pair of
+    // nodes in a cluster worked out up front. A long search then only visits entrances, and only the part of the path up to the next
+    // cluster has to be searched tile by tile.
+    // Only the level geometry is considered, actors are left to the tile searches, as they move far too often to be baked in.
+    class PathGraph
+    {
+    public:
+        static constexpr int32_t CLUSTER_SIZE = 10;
+
+        void build(const GameLevelImpl& level);
+
+        // Rebuilds the clusters whose entrances or costs could have changed when the passability of tiles in the given area changed
+        void rebuildArea(const GameLevelImpl& level, Misc::Point topLeft, Misc::Point bottomRight);
+
+        // Entrances on the way from start to goal, ending with goal, or empty if goal can't be reached or either point is off the level.
+        // Only the level geometry is considered, so this doesn't promise an actor can walk it right now.
+        Misc::Points findAbstractPath(const GameLevelImpl& level, Misc::Point start, Misc::Point goal);
+
+        // The first entrance on the abstract path that is outside start's cluster, or false if start and goal share a cluster,
+        // either is off the level, or there is no abstract path. Searching tile by tile to this point is the first segment of the full path.
+        bool findNextWaypoint(const GameLevelImpl& level, Misc::Point start, Misc::Point goal, Misc::Point& waypoint);
+
+        int32_t clusterIndex(Misc::Point point) const { return (point.y / CLUSTER_SIZE) * mClustersWide + point.x / CLUSTER_SIZE; }
+
+    private:
+        struct Edge
+        {
+            int32_t to; // Node index in the same cluster
+            int32_t cost;
+        };
+
+        struct Node
+        {
+            Misc::Point tile;
+            Misc::Points partners; // Tiles just across the cluster border, each of which is a node in the neighbouring cluster
+            std::vector<Edge> edges;
+        };
+
+        struct Cluster
+        {
+            Misc::Point origin;
+            int32_t width = 0;
+            int32_t height = 0;
+            std::vector<Node> nodes;
+        };
+
+        struct OpenNode
+        {
+            int32_t priority;
+            int32_t id;
+        };
+
+        void buildCluster(const GameLevelImpl& level, int32_t index);
+        void addEntrances(const GameLevelImpl& level, Cluster& cluster, Misc::Point borderStart, Misc::Point step, Misc::Point across);
+        void addNode(Cluster& cluster, Misc::Point tile, Misc::Point partner);
+
+        // Fills mDistances with the walking cost from source to each tile of the cluster, without leaving it
+        void clusterDistances(const GameLevelImpl& level, const Cluster& cluster, Misc::Point source);
+        int32_t clusterDistance(const Cluster& cluster, Misc::Point tile) const;
+
+        // Also false before the graph is built, as the size is still 0
+        bool inBounds(Misc::Point point) const { return point.x >= 0 && point.x < mWidth && point.y >= 0 && point.y < mHeight; }
+
+        int32_t nodeId(int32_t cluster, int32_t node) const { return mNodeOffsets[cluster] + node; }
+        bool abstractSearch(const GameLevelImpl& level, Misc::Point start, Misc::Point goal);
+
+        int32_t mWidth = 0;
+        int32_t mHeight = 0;
+        int32_t mClustersWide = 0;
+        int32_t mClustersHigh = 0;
+        std::vector<Cluster> mClusters;
+
+        // Node ids for the abstract search are the node's index in its cluster, offset by the node count of the clusters before it.
+        // The start and goal of a search get the two ids after the last node.
+        std::vector<int32_t> mNodeOffsets;
+        int32_t mNodeCount = 0;
+
+        // Scratch space kept between searches
+        std::vector<int32_t> mDistances;
+        std::vector<std::pair<int32_t, int32_t>> mDistanceOpen;
+        std::vector<int32_t> mStartCosts;
+        std::vector<int32_t> mGoalCosts;
+        std::vector<OpenNode> mOpen;
+        std::vector<int32_t> mCostSoFar;
+        std::vector<int32_t> mCameFrom;
+        std::vector<Misc::Point> mNodeTiles;
+    };
+}
@@ -20,8 +20,6 @@
 
 namespace FAWorld
 {
-    const std::string Player::typeId = "player";
-
     Player::Player(World& world, PlayerClass playerClass, const DiabloExe::CharacterStats& charStats) : Actor(world), mPlayerClass(playerClass)
     {
         mStats.initialise(initialiseActorStats(charStats));
@@ -462,13 +460,13 @@ namespace FAWorld
                 weapon = weapon + "-shield";
         }
 
-        FARender::Renderer* renderer = FARender::Renderer::get();
-        if (!renderer) // TODO: some sort of headless mode for tests
+        FARender::SpriteLoader* spriteLoader = FARender::SpriteLoader::get();
+        if (!spriteLoader) // unit tests don't load any sprites
             return;
 
         auto getAnimation = [&](const std::string& animation) {
             FARender::SpriteLoader::PlayerSpriteKey spriteLookupKey({{"animation", animation}, {"class", classCode}, {"armor", armor}, {"weapon", weapon}});
-            return renderer->mSpriteLoader.getSprite(renderer->mSpriteLoader.mPlayerSpriteDefinitions.at(spriteLookupKey));
+            return spriteLoader->getSprite(spriteLoader->mPlayerSpriteDefinitions.at(spriteLookupKey));
         };
 
         mAnimation.setAnimationSprites(AnimState::dead, getAnimation("dead"));
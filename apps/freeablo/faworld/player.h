@@ -10,8 +10,8 @@ namespace FAWorld
     class Player : public Actor
     {
     public:
-        static const std::string typeId;
-        const std::string& getTypeId() override { return typeId; }
+        static constexpr FASaveGame::TypeId typeId = FASaveGame::TypeId::player;
+        FASaveGame::TypeId getTypeId() override { return typeId; }
 
         Player(World& world, PlayerClass playerClass, const DiabloExe::CharacterStats& charStats);
         void initCommon();
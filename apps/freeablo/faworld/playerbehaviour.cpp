@@ -15,8 +15,6 @@
 
 namespace FAWorld
 {
-    const std::string PlayerBehaviour::typeId = "playerBehaviour";
-
     PlayerBehaviour::PlayerBehaviour(Actor* actor)
     {
         release_assert(actor->getTypeId() == Player::typeId);
@@ -7,8 +7,8 @@ namespace FAWorld
     class PlayerBehaviour : public Behaviour
     {
     public:
-        static const std::string typeId;
-        const std::string& getTypeId() override { return typeId; }
+        static constexpr FASaveGame::TypeId typeId = FASaveGame::TypeId::playerBehaviour;
+        FASaveGame::TypeId getTypeId() override { return typeId; }
 
         PlayerBehaviour(FAWorld::Actor* actor);
         PlayerBehaviour(FASaveGame::GameLoader& loader);
@@ -199,7 +199,8 @@ namespace FAWorld
 
         static void removeUnnecessaryInputs(std::vector<PlayerInput>& inputs);
 
-        static constexpr int32_t MAX_SERIALISED_INPUT_SIZE = 50;
+        // Inputs are sent with Serial::PackedWriteStream, where the largest one (SellItem) is at most 22 bytes
+        static constexpr int32_t MAX_SERIALISED_INPUT_SIZE = 24;
     };
 }
 
@@ -20,6 +20,7 @@
 #include <diabloexe/diabloexe.h>
 #include <iostream>
 #include <misc/assert.h>
+#include <serial/hashstream.h>
 #include <serial/textstream.h>
 #include <tuple>
 
@@ -38,14 +39,17 @@ namespace FAWorld
 
     void World::generateStoreItems() { mStoreData->generateGriswoldBasicItems(10 /*placeholder*/, *mRng.get()); }
 
-    void World::load(FASaveGame::GameLoader& loader)
+    void World::resetForLoading()
     {
         // reconstruct in-place to reset to default state
-        {
-            const DiabloExe::DiabloExe& tmp = mDiabloExe;
-            this->~World();
-            new (this) World(tmp, 0U);
-        }
+        const DiabloExe::DiabloExe& tmp = mDiabloExe;
+        this->~World();
+        new (this) World(tmp, 0U);
+    }
+
+    void World::load(FASaveGame::GameLoader& loader)
+    {
+        resetForLoading();
 
         mLoading = true;
         loader.currentlyLoadingWorld = this;
@@ -102,6 +106,93 @@ namespace FAWorld
         mStoreData->save(saver);
     }
 
+    void World::saveGlobals(FASaveGame::GameSaver& saver) const
+    {
+        mRng->save(saver);
+        mLevelRng->save(saver);
+        saver.save(this->mTicksPassed);
+        saver.save(mNextId);
+        saver.save(uint8_t(mNextPlayerClass));
+        mStoreData->save(saver);
+    }
+
+    uint64_t World::getGlobalsChecksum() const
+    {
+        Serial::HashWriteStream stream;
+        FASaveGame::GameSaver saver(stream);
+        saveGlobals(saver);
+
+        return stream.getHash();
+    }
+
+    void World::saveLevel(FASaveGame::GameSaver& saver, int32_t levelIndex) const
+    {
+        GameLevel* level = mLevels.at(levelIndex);
+
+        bool hasThisLevel = level != nullptr;
+        saver.save(hasThisLevel);
+
+        if (hasThisLevel)
+            level->save(saver);
+    }
+
+    void World::load(FASaveGame::GameLoader& globalsLoader, const std::map<int32_t, FASaveGame::GameLoader*>& levelLoaders)
+    {
+        resetForLoading();
+
+        mLoading = true;
+        globalsLoader.currentlyLoadingWorld = this;
+
+        mRng->load(globalsLoader);
+        mLevelRng->load(globalsLoader);
+        this->mTicksPassed = globalsLoader.load<Tick>();
+        mNextId = globalsLoader.load<int32_t>();
+        mNextPlayerClass = PlayerClass(globalsLoader.load<uint8_t>());
+        mStoreData->load(globalsLoader);
+
+        for (const auto& pair : levelLoaders)
+            loadLevel(pair.first, *pair.second);
+
+        // Actors can refer to actors on other levels, so wait until everything is loaded before resolving references
+        globalsLoader.runFunctionsToRunAtEnd();
+        for (const auto& pair : levelLoaders)
+        {
+            pair.second->runFunctionsToRunAtEnd();
+            pair.second->currentlyLoadingWorld = nullptr;
+        }
+
+        mLoading = false;
+        globalsLoader.currentlyLoadingWorld = nullptr;
+    }
+
+    void World::loadLevel(int32_t levelIndex, FASaveGame::GameLoader& loader)
+    {
+        loader.currentlyLoadingWorld = this;
+
+        bool hasThisLevel = loader.load<bool>();
+        mLevels[levelIndex] = hasThisLevel ? new GameLevel(*this, loader) : nullptr;
+    }
+
+    void World::addPendingLevel(int32_t levelIndex)
+    {
+        release_assert(mLevels.count(levelIndex) == 0);
+
+        mLevels[levelIndex] = nullptr;
+        mPendingLevels.insert(levelIndex);
+    }
+
+    void World::loadPendingLevel(int32_t levelIndex, FASaveGame::GameLoader& loader)
+    {
+        release_assert(mPendingLevels.erase(levelIndex) == 1);
+
+        mLoading = true;
+        loadLevel(levelIndex, loader);
+        loader.runFunctionsToRunAtEnd();
+        mLoading = false;
+
+        loader.currentlyLoadingWorld = nullptr;
+    }
+
     void World::setupObjectIdMappers()
     {
         mObjectIdMapper.addClass(Actor::typeId, [&](FASaveGame::GameLoader& loader) { return new Actor(*this, loader); });
@@ -283,6 +374,12 @@ namespace FAWorld
 
     GameLevel* World::getLevel(size_t level)
     {
+        if (isLevelPending(int32_t(level)))
+        {
+            Engine::EngineMain::get()->mMultiplayer->waitForLevel(int32_t(level));
+            release_assert(!isLevelPending(int32_t(level)));
+        }
+
         auto p = mLevels.find(level);
         if (p == mLevels.end())
             return nullptr;
@@ -372,7 +469,14 @@ namespace FAWorld
         mPlayers.insert(sortedInsertPosIt, player);
     }
 
-    void World::deregisterPlayer(Player* player) { mPlayers.erase(std::find(mPlayers.begin(), mPlayers.end(), player)); }
+    void World::deregisterPlayer(Player* player)
+    {
+        mPlayers.erase(std::find(mPlayers.begin(), mPlayers.end(), player));
+
+        // Spectators follow someone else's player, who can leave
+        if (mCurrentPlayer == player)
+            mCurrentPlayer = nullptr;
+    }
 
     const std::vector<Player*>& World::getPlayers() { return mPlayers; }
 
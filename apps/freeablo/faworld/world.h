@@ -6,6 +6,7 @@
 #include <map>
 #include <memory>
 #include <misc/fixedpoint.h>
+#include <set>
 #include <utility>
 #include <vector>
 
@@ -62,6 +63,23 @@ namespace FAWorld
         void load(FASaveGame::GameLoader& loader);
         ~World();
 
+        // Used by the autosave journal, which stores each level separately so levels that haven't changed don't need to be saved again.
+        // Levels are loaded with their own loaders, so they can come from different journal entries.
+        void saveGlobals(FASaveGame::GameSaver& saver) const;
+        void saveLevel(FASaveGame::GameSaver& saver, int32_t levelIndex) const;
+        void load(FASaveGame::GameLoader& globalsLoader, const std::map<int32_t, FASaveGame::GameLoader*>& levelLoaders);
+        const std::map<int32_t, GameLevel*>& getLevels() const { return mLevels; } ///< Levels that haven't been generated yet are nullptr
+
+        // Hash of the data written by saveGlobals(), see GameLevel::getChecksum()
+        uint64_t getGlobalsChecksum() const;
+
+        // Multiplayer clients receive the levels nobody is on after the rest of the world, see Engine::Server::sendMapToPeer().
+        // Pending levels exist on the server, so they must not be generated locally. If the simulation needs one before it has arrived,
+        // getLevel() blocks until the multiplayer interface has received it.
+        void addPendingLevel(int32_t levelIndex);
+        bool isLevelPending(int32_t levelIndex) const { return mPendingLevels.count(levelIndex) != 0; }
+        void loadPendingLevel(int32_t levelIndex, FASaveGame::GameLoader& loader);
+
         void setFirstPlayerAsCurrent();
 
         Render::Tile getTileByScreenPos(Misc::Point screenPos);
@@ -116,8 +134,12 @@ namespace FAWorld
         bool mLoading = false; // not serialised, for obvious reasons
 
     private:
+        void resetForLoading();
+        void loadLevel(int32_t levelIndex, FASaveGame::GameLoader& loader);
+
         std::unique_ptr<Random::Rng> mLevelRng;
         std::map<int32_t, GameLevel*> mLevels;
+        std::set<int32_t> mPendingLevels; ///< not serialised, only used while joining a multiplayer game
         Tick mTicksPassed = 0;
         Player* mCurrentPlayer = nullptr;
         std::vector<Player*> mPlayers; ///< This vector is sorted
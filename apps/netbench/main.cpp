@@ -0,0 +1,679 @@
+#include <algorithm>
+#include <cel/celdecoder.h>
+#include <chrono>
+#include <cstdlib>
+#include <cxxopts.hpp>
+#include <deque>
+#include <diabloexe/diabloexe.h>
+#include <engine/enginemain.h>
+#include <engine/net/multiplayerinterface.h>
+#include <engine/net/server.h>
+#include <engine/threadmanager.h>
+#include <enet/enet.h>
+#include <faio/faio.h>
+#include <farender/spriteloader.h>
+#include <fasavegame/gameloader.h>
+#include <faworld/playerinput.h>
+#include <faworld/world.h>
+#include <fmt/format.h>
+#include <iostream>
+#include <map>
+#include <misc/assert.h>
+#include <misc/misc.h>
+#include <random>
+#include <serial/packedstream.h>
+#include <set>
+#include <settings/settings.h>
+#include <thread>
+
+// Load test for the multiplayer server. Runs an Engine::Server in this process, the same way faserver does, and connects a number of
+// simulated clients to it over ENet on localhost. The simulated clients speak the same protocol as Engine::Client, but don't run a world,
+// they just click on random tiles and record when the server sends their clicks back. The test is repeated with the number of clients
+// doubling each time, up to --clients. With --latency or --jitter, the clients connect through a proxy that delays every datagram,
+// to see how the server's input delay adapts. With --spectators, that many spectators watch every test, to see what they cost.
+// Needs the game data to be set up, same as freeablo itself.
+
+namespace
+{
+    using clock = std::chrono::steady_clock;
+    using MessageType = Engine::MultiplayerInterface::MessageType;
+
+    constexpr size_t MAX_CLIENT_UPDATE_PACKET_SIZE = 250; // same as Engine::Client
+    constexpr uint16_t SERVER_PORT = 6666;                // same as Engine::Server
+
+    // Stands in for a slow network between the simulated clients and the server. Forwards UDP datagrams both ways over localhost,
+    // holding each one back for half the round trip time, plus a random amount of jitter. Every client gets its own socket towards
+    // the server, so the server still sees them as separate peers.
+    class LatencyProxy
+    {
+    public:
+        static constexpr uint16_t PORT = 6667;
+
+        LatencyProxy(uint32_t roundTripMilliseconds, uint32_t jitterMilliseconds, uint32_t seed)
+            : mRng(seed), mOneWayDelay(roundTripMilliseconds / 2), mJitter(0, jitterMilliseconds)
+        {
+            mSocket = createSocket(PORT);
+            enet_address_set_host(&mServerAddress, "127.0.0.1");
+            mServerAddress.port = SERVER_PORT;
+        }
+
+        ~LatencyProxy()
+        {
+            for (const auto& route : mRoutes)
+                enet_socket_destroy(route.second.upstream);
+            enet_socket_destroy(mSocket);
+        }
+
+        void update()
+        {
+            receiveAll(mSocket, [&](const ENetAddress& from, const uint8_t* data, size_t size) {
+                Route& route = getRoute(from);
+                queue(route.upstream, mServerAddress, data, size);
+            });
+
+            for (auto& pair : mRoutes)
+            {
+                Route& route = pair.second;
+                receiveAll(route.upstream, [&](const ENetAddress&, const uint8_t* data, size_t size) { queue(mSocket, route.client, data, size); });
+            }
+
+            clock::time_point now = clock::now();
+            while (!mPending.empty() && mPending.begin()->first <= now)
+            {
+                Datagram& datagram = mPending.begin()->second;
+
+                ENetBuffer buffer;
+                buffer.data = datagram.data.data();
+                buffer.dataLength = datagram.data.size();
+                enet_socket_send(datagram.socket, &datagram.to, &buffer, 1);
+
+                mPending.erase(mPending.begin());
+            }
+        }
+
+    private:
+        struct Route
+        {
+            ENetAddress client;
+            ENetSocket upstream;
+        };
+
+        struct Datagram
+        {
+            ENetSocket socket;
+            ENetAddress to;
+            std::vector<uint8_t> data;
+        };
+
+        static ENetSocket createSocket(uint16_t port)
+        {
+            ENetAddress address;
+            address.host = ENET_HOST_ANY;
+            address.port = port;
+
+            ENetSocket socket = enet_socket_create(ENET_SOCKET_TYPE_DATAGRAM);
+            release_assert(socket != ENET_SOCKET_NULL);
+            enet_socket_set_option(socket, ENET_SOCKOPT_REUSEADDR, 1);
+            enet_socket_set_option(socket, ENET_SOCKOPT_NONBLOCK, 1);
+
+            if (enet_socket_bind(socket, &address) != 0)
+                message_and_abort_fmt("latency proxy could not bind to port %u\n", uint32_t(port));
+
+            return socket;
+        }
+
+        template <typename Callback> void receiveAll(ENetSocket socket, Callback&& callback)
+        {
+            uint8_t data[ENET_PROTOCOL_MAXIMUM_MTU];
+            ENetBuffer buffer;
+            buffer.data = data;
+            buffer.dataLength = sizeof(data);
+
+            ENetAddress from;
+            int size;
+            while ((size = enet_socket_receive(socket, &from, &buffer, 1)) > 0)
+                callback(from, data, size_t(size));
+        }
+
+        Route& getRoute(const ENetAddress& client)
+        {
+            auto key = std::make_pair(client.host, client.port);
+
+            auto it = mRoutes.find(key);
+            if (it == mRoutes.end())
+                it = mRoutes.emplace(key, Route{client, createSocket(0)}).first;
+
+            return it->second;
+        }
+
+        void queue(ENetSocket socket, const ENetAddress& to, const uint8_t* data, size_t size)
+        {
+            clock::time_point due = clock::now() + std::chrono::milliseconds(mOneWayDelay + mJitter(mRng));
+            mPending.emplace(due, Datagram{socket, to, std::vector<uint8_t>(data, data + size)});
+        }
+
+        std::mt19937 mRng;
+        uint32_t mOneWayDelay = 0;
+        std::uniform_int_distribution<uint32_t> mJitter;
+
+        ENetSocket mSocket;
+        ENetAddress mServerAddress;
+        std::map<std::pair<enet_uint32, enet_uint16>, Route> mRoutes;
+        std::multimap<clock::time_point, Datagram> mPending;
+    };
+
+    class SimulatedClient
+    {
+    public:
+        SimulatedClient(uint32_t seed, int32_t inputInterval, uint16_t port, bool spectator)
+            : mRng(seed), mInputInterval(inputInterval), mSpectator(spectator)
+        {
+            ENetAddress address;
+            address.port = port;
+            enet_address_set_host(&address, "127.0.0.1");
+
+            mHost = enet_host_create(nullptr, 1, 2, 0, 0);
+            mHost->checksum = enet_crc32;
+            auto connectType = spectator ? Engine::MultiplayerInterface::ConnectType::Spectator : Engine::MultiplayerInterface::ConnectType::Player;
+            mServerPeer = enet_host_connect(mHost, &address, Engine::MultiplayerInterface::CHANNEL_ID_END, uint32_t(connectType));
+            mConnectStartTime = clock::now();
+        }
+
+        ~SimulatedClient()
+        {
+            enet_peer_disconnect_now(mServerPeer, 0);
+            enet_host_destroy(mHost);
+        }
+
+        void update()
+        {
+            ENetEvent event;
+            while (enet_host_service(mHost, &event, 0) > 0)
+            {
+                if (event.type == ENET_EVENT_TYPE_RECEIVE)
+                {
+                    receivePacket(*event.packet);
+                    enet_packet_destroy(event.packet);
+                }
+                else if (event.type == ENET_EVENT_TYPE_CONNECT)
+                {
+                    enet_peer_timeout(mServerPeer, 99999, 99999, 99999);
+                }
+                else if (event.type == ENET_EVENT_TYPE_DISCONNECT)
+                {
+                    message_and_abort("simulated client was disconnected from the server");
+                }
+            }
+
+            if (hasMap())
+                sendClientUpdate();
+
+            enet_host_flush(mHost);
+        }
+
+        // True once the map and all the levels sent after it have arrived
+        bool isSynced() const { return hasMap() && mPendingLevels == 0; }
+        double getJoinMilliseconds() const { return std::chrono::duration<double, std::milli>(mSyncedTime - mConnectStartTime).count(); }
+
+        // Bytes on the wire, including ENet's own headers and acks
+        uint32_t getBytesReceived() const { return mHost->totalReceivedData; }
+        uint32_t getBytesSent() const { return mHost->totalSentData; }
+
+        // Ticks between us sending an input, and the server executing it, as seen from the tick we were on when we sent it
+        const std::vector<FAWorld::Tick>& getInputLatencies() const { return mInputLatencies; }
+        size_t getLostInputs() const { return mLostInputs; }
+        // The server's input delay, averaged over all the inputs packets we received
+        double getAverageInputDelay() const { return mInputDelayPackets ? double(mInputDelayTotal) / double(mInputDelayPackets) : 0.0; }
+        void clearStats()
+        {
+            mInputLatencies.clear();
+            mLostInputs = 0;
+            mInputDelayTotal = 0;
+            mInputDelayPackets = 0;
+        }
+
+    private:
+        bool hasMap() const { return mHasMap; }
+
+        void receivePacket(const ENetPacket& packet)
+        {
+            Serial::PackedReadStream stream(packet.data, packet.dataLength);
+            FASaveGame::GameLoader loader(stream);
+
+            MessageType type = MessageType(loader.load<uint8_t>());
+
+            switch (type)
+            {
+                case MessageType::MapToClient:
+                {
+                    receiveMap(loader);
+                    return;
+                }
+                case MessageType::InputsToClient:
+                {
+                    receiveInputs(loader);
+                    return;
+                }
+                case MessageType::LevelToClient:
+                {
+                    release_assert(mPendingLevels > 0);
+                    if (--mPendingLevels == 0)
+                        mSyncedTime = clock::now();
+                    return;
+                }
+                case MessageType::VerifyToClient:
+                    // We have no world to check these against
+                    return;
+
+                case MessageType::AcknowledgeMapToServer:
+                case MessageType::ClientUpdateToServer:
+                    invalid_enum(MessageType, type);
+            }
+
+            invalid_enum(MessageType, type);
+        }
+
+        void receiveMap(FASaveGame::GameLoader& loader)
+        {
+            // see Server::sendMapToPeer for the format, we only need the header and the number of levels still to come
+            mActorId = loader.load<int32_t>();
+            mHasMap = true;
+            // The snapshot can be older than the server's current tick, which comes next
+            mNextTick = loader.load<FAWorld::Tick>();
+            loader.load<FAWorld::Tick>();
+            loader.load<std::string>();
+
+            uint32_t levelCount = loader.load<uint32_t>();
+            for (uint32_t i = 0; i < levelCount; i++)
+            {
+                loader.load<int32_t>();
+                loader.load<std::string>();
+            }
+
+            mPendingLevels = loader.load<uint32_t>();
+            if (mPendingLevels == 0)
+                mSyncedTime = clock::now();
+
+            Serial::PackedWriteStream stream;
+            FASaveGame::GameSaver saver(stream);
+            saver.save(uint8_t(MessageType::AcknowledgeMapToServer));
+            auto data = stream.getData();
+
+            enet_peer_send(mServerPeer, Engine::MultiplayerInterface::RELIABLE_CHANNEL_ID, enet_packet_create(data.first, data.second, ENET_PACKET_FLAG_RELIABLE));
+        }
+
+        void receiveInputs(FASaveGame::GameLoader& loader)
+        {
+            // see Engine::Server::sendInputsToClients for the format
+            mInputDelayTotal += loader.load<FAWorld::Tick>();
+            mInputDelayPackets++;
+
+            FAWorld::Tick tick = 0;
+            while (loader.load<bool>())
+            {
+                tick += loader.load<FAWorld::Tick>();
+
+                std::vector<FAWorld::PlayerInput> inputs(loader.load<uint32_t>());
+                for (FAWorld::PlayerInput& input : inputs)
+                    input.load(loader);
+
+                // Ticks are resent until the server knows we have them, so we'll see most of them more than once
+                if (tick < mNextTick || mTicksReceivedAhead.count(tick))
+                    continue;
+
+                for (const FAWorld::PlayerInput& input : inputs)
+                {
+                    if (input.mActorId == mActorId && input.mType == FAWorld::PlayerInput::Type::TargetTile)
+                        onOwnInputExecuted(input.mData.dataTargetTile, tick);
+                }
+
+                mTicksReceivedAhead.insert(tick);
+                while (mTicksReceivedAhead.count(mNextTick))
+                    mTicksReceivedAhead.erase(mNextTick++);
+            }
+        }
+
+        void onOwnInputExecuted(const FAWorld::PlayerInput::TargetTileData& data, FAWorld::Tick tick)
+        {
+            // Inputs are executed in the order we sent them, so anything before this one was dropped by the server
+            while (!mInputsInFlight.empty())
+            {
+                InputInFlight sent = mInputsInFlight.front();
+                mInputsInFlight.pop_front();
+
+                if (sent.x == data.x && sent.y == data.y)
+                {
+                    mInputLatencies.push_back(tick - sent.tick);
+                    return;
+                }
+
+                mLostInputs++;
+            }
+        }
+
+        void sendClientUpdate()
+        {
+            // Same as Engine::Client::sendClientUpdate(), we send a new (possibly empty) input set every tick, and resend as many of the
+            // previous ones as will fit, as the server might not have received them yet.
+            mLastInputSetId++;
+            std::vector<FAWorld::PlayerInput>& inputSet = mInputSets[mLastInputSetId];
+
+            if (!mSpectator && mTicksSinceLastInput++ >= mInputInterval)
+            {
+                std::uniform_int_distribution<int32_t> coordinate(0, 95);
+                InputInFlight sent{coordinate(mRng), coordinate(mRng), mNextTick};
+
+                inputSet.emplace_back(FAWorld::PlayerInput::TargetTileData{sent.x, sent.y}, mActorId);
+                mInputsInFlight.push_back(sent);
+                mTicksSinceLastInput = 0;
+            }
+
+            Serial::PackedWriteStream stream;
+            FASaveGame::GameSaver saver(stream);
+
+            saver.save(uint8_t(MessageType::ClientUpdateToServer));
+            saver.save(mNextTick);
+
+            size_t lastInputSetEndPosition = 0;
+            for (auto it = mInputSets.rbegin(); it != mInputSets.rend(); ++it)
+            {
+                saver.save(true);
+                saver.save(it->first);
+                saver.save(uint32_t(it->second.size()));
+                for (const FAWorld::PlayerInput& input : it->second)
+                    input.save(saver);
+
+                if (stream.getCurrentSize() > MAX_CLIENT_UPDATE_PACKET_SIZE)
+                {
+                    mInputSets.erase(mInputSets.begin(), it.base());
+                    break;
+                }
+
+                lastInputSetEndPosition = stream.getCurrentSize();
+            }
+
+            stream.resize(lastInputSetEndPosition);
+            saver.save(false);
+
+            auto data = stream.getData();
+            enet_peer_send(mServerPeer,
+                           Engine::MultiplayerInterface::CLIENT_TO_SERVER_CHANNEL_ID,
+                           enet_packet_create(data.first, data.second, ENET_PACKET_FLAG_UNSEQUENCED));
+        }
+
+        struct InputInFlight
+        {
+            int32_t x;
+            int32_t y;
+            FAWorld::Tick tick;
+        };
+
+        ENetHost* mHost = nullptr;
+        ENetPeer* mServerPeer = nullptr;
+
+        std::mt19937 mRng;
+        int32_t mInputInterval = 0;
+        int32_t mTicksSinceLastInput = 0;
+
+        bool mSpectator = false;
+        bool mHasMap = false;
+        int32_t mActorId = -1;
+        uint32_t mPendingLevels = 0;
+        clock::time_point mConnectStartTime;
+        clock::time_point mSyncedTime;
+
+        FAWorld::Tick mNextTick = 0; ///< The first tick we don't have the inputs for yet
+        std::set<FAWorld::Tick> mTicksReceivedAhead;
+
+        uint32_t mLastInputSetId = 0;
+        std::map<uint32_t, std::vector<FAWorld::PlayerInput>> mInputSets;
+        std::deque<InputInFlight> mInputsInFlight;
+
+        std::vector<FAWorld::Tick> mInputLatencies;
+        size_t mLostInputs = 0;
+        FAWorld::Tick mInputDelayTotal = 0;
+        size_t mInputDelayPackets = 0;
+    };
+
+    struct Result
+    {
+        size_t clients = 0;
+        double joinMilliseconds = 0;
+        double averageTickMilliseconds = 0;
+        double maxTickMilliseconds = 0;
+        double bytesDownPerTick = 0;
+        double bytesUpPerTick = 0;
+        double averageLatency = 0;
+        FAWorld::Tick maxLatency = 0;
+        size_t lostInputs = 0;
+        double averageInputDelay = 0;
+        double spectatorBytesDownPerTick = 0;
+    };
+
+    struct TestOptions
+    {
+        uint32_t seed = 0;
+        int32_t ticks = 0;
+        int32_t inputInterval = 0;
+        uint32_t roundTripMilliseconds = 0;
+        uint32_t jitterMilliseconds = 0;
+        size_t spectators = 0;
+    };
+
+    Result runTest(Engine::EngineMain& engine, const TestOptions& options, size_t clientCount)
+    {
+        engine.startDedicatedServer(options.seed);
+
+        std::unique_ptr<LatencyProxy> proxy;
+        if (options.roundTripMilliseconds || options.jitterMilliseconds)
+            proxy = std::make_unique<LatencyProxy>(options.roundTripMilliseconds, options.jitterMilliseconds, options.seed);
+
+        uint16_t port = proxy ? LatencyProxy::PORT : SERVER_PORT;
+
+        std::vector<std::unique_ptr<SimulatedClient>> clients;
+        for (size_t i = 0; i < clientCount; i++)
+            clients.push_back(std::make_unique<SimulatedClient>(options.seed + uint32_t(i), options.inputInterval, port, false));
+
+        std::vector<std::unique_ptr<SimulatedClient>> spectators;
+        for (size_t i = 0; i < options.spectators; i++)
+            spectators.push_back(std::make_unique<SimulatedClient>(options.seed, options.inputInterval, port, true));
+
+        auto updateClients = [&]() {
+            for (auto& client : clients)
+                client->update();
+            for (auto& spectator : spectators)
+                spectator->update();
+        };
+
+        // The proxy is pumped while we wait, so the delays it adds aren't rounded up to whole ticks
+        auto sleepUntilNextTick = [&](clock::time_point tickStartTime) {
+            clock::time_point nextTickTime = tickStartTime + std::chrono::milliseconds(1000 / FAWorld::World::ticksPerSecond);
+
+            if (!proxy)
+            {
+                std::this_thread::sleep_until(nextTickTime);
+                return;
+            }
+
+            do
+            {
+                proxy->update();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            } while (clock::now() < nextTickTime);
+        };
+
+        auto updateAll = [&]() {
+            clock::time_point tickStartTime = clock::now();
+
+            engine.updateDedicatedServer();
+            updateClients();
+
+            return tickStartTime;
+        };
+
+        // Everyone joins before we start measuring, so the map transfers don't skew the numbers
+        clock::time_point joinDeadline = clock::now() + std::chrono::seconds(60);
+        auto isSynced = [](const auto& client) { return client->isSynced(); };
+        while (!std::all_of(clients.begin(), clients.end(), isSynced) || !std::all_of(spectators.begin(), spectators.end(), isSynced))
+        {
+            if (clock::now() > joinDeadline)
+                message_and_abort_fmt("%zu simulated clients did not finish joining within 60 seconds\n", clientCount);
+
+            sleepUntilNextTick(updateAll());
+        }
+
+        Result result;
+        result.clients = clientCount;
+
+        std::vector<uint32_t> bytesReceivedAtStart;
+        std::vector<uint32_t> bytesSentAtStart;
+        for (auto& client : clients)
+        {
+            result.joinMilliseconds += client->getJoinMilliseconds() / double(clientCount);
+            bytesReceivedAtStart.push_back(client->getBytesReceived());
+            bytesSentAtStart.push_back(client->getBytesSent());
+            client->clearStats();
+        }
+
+        std::vector<uint32_t> spectatorBytesReceivedAtStart;
+        for (auto& spectator : spectators)
+            spectatorBytesReceivedAtStart.push_back(spectator->getBytesReceived());
+
+        int32_t ticks = options.ticks;
+        FAWorld::Tick serverTickAtStart = engine.mWorld->getCurrentTick();
+        for (int32_t i = 0; i < ticks; i++)
+        {
+            clock::time_point tickStartTime = clock::now();
+            engine.updateDedicatedServer();
+            double tickMilliseconds = std::chrono::duration<double, std::milli>(clock::now() - tickStartTime).count();
+
+            updateClients();
+
+            result.averageTickMilliseconds += tickMilliseconds / ticks;
+            result.maxTickMilliseconds = std::max(result.maxTickMilliseconds, tickMilliseconds);
+
+            sleepUntilNextTick(tickStartTime);
+        }
+
+        // The server schedules inputs ahead for the clients, but must still only run one tick per update, however big the input delay is
+        FAWorld::Tick serverTicks = engine.mWorld->getCurrentTick() - serverTickAtStart;
+        if (serverTicks != ticks)
+            message_and_abort_fmt("server ran %d ticks in %d updates\n", int32_t(serverTicks), ticks);
+
+        size_t latencyCount = 0;
+        for (size_t i = 0; i < clients.size(); i++)
+        {
+            const SimulatedClient& client = *clients[i];
+
+            result.bytesDownPerTick += double(client.getBytesReceived() - bytesReceivedAtStart[i]) / ticks / double(clientCount);
+            result.bytesUpPerTick += double(client.getBytesSent() - bytesSentAtStart[i]) / ticks / double(clientCount);
+            result.lostInputs += client.getLostInputs();
+            result.averageInputDelay += client.getAverageInputDelay() / double(clientCount);
+
+            for (FAWorld::Tick latency : client.getInputLatencies())
+            {
+                result.averageLatency += double(latency);
+                result.maxLatency = std::max(result.maxLatency, latency);
+                latencyCount++;
+            }
+        }
+
+        if (latencyCount)
+            result.averageLatency /= double(latencyCount);
+
+        for (size_t i = 0; i < spectators.size(); i++)
+        {
+            uint32_t bytesReceived = spectators[i]->getBytesReceived() - spectatorBytesReceivedAtStart[i];
+            result.spectatorBytesDownPerTick += double(bytesReceived) / ticks / double(spectators.size());
+        }
+
+        // Disconnect before the server goes away, so it doesn't wait on us
+        clients.clear();
+        spectators.clear();
+        for (int32_t i = 0; i < 10; i++)
+            sleepUntilNextTick(updateAll());
+
+        return result;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Misc::saveArgv0(argv[0]);
+
+    cxxopts::Options desc("netbench", "Measures the multiplayer server with simulated clients on localhost");
+    desc.add_options()("h,help", "Print help")("clients", "Maximum number of simulated clients (1-32)", cxxopts::value<int32_t>()->default_value("16"))(
+        "ticks", "Number of ticks to measure for each client count", cxxopts::value<int32_t>()->default_value("600"))(
+        "input-interval", "Ticks between each simulated client's clicks", cxxopts::value<int32_t>()->default_value("30"))(
+        "seed", "World seed", cxxopts::value<uint32_t>()->default_value("1234"))(
+        "latency", "Round trip time to add between the clients and the server, in milliseconds", cxxopts::value<uint32_t>()->default_value("0"))(
+        "jitter", "Random extra delay of up to this many milliseconds for each datagram", cxxopts::value<uint32_t>()->default_value("0"))(
+        "spectators", "Number of spectators watching each test (0-32)", cxxopts::value<int32_t>()->default_value("0"));
+
+    cxxopts::ParseResult variables;
+    try
+    {
+        variables = desc.parse(argc, argv);
+    }
+    catch (cxxopts::OptionParseException& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl << std::endl;
+        std::cerr << desc.help() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (variables.count("help"))
+    {
+        std::cout << desc.help() << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    size_t maxClients = size_t(std::clamp(variables["clients"].as<int32_t>(), 1, int32_t(Engine::Server::MAX_PLAYERS)));
+    TestOptions options;
+    options.ticks = std::max(variables["ticks"].as<int32_t>(), 1);
+    options.inputInterval = std::max(variables["input-interval"].as<int32_t>(), 0);
+    options.seed = variables["seed"].as<uint32_t>();
+    options.roundTripMilliseconds = variables["latency"].as<uint32_t>();
+    options.jitterMilliseconds = variables["jitter"].as<uint32_t>();
+    options.spectators = size_t(std::clamp(variables["spectators"].as<int32_t>(), 0, int32_t(Engine::Server::MAX_SPECTATORS)));
+
+    Settings::Settings settings;
+    if (!settings.loadUserSettings())
+        return EXIT_FAILURE;
+
+    FAIO::ScopedInitFAIO faioInit(settings.get<std::string>("Game", "PathMPQ"));
+    Cel::CelDecoder::loadConfigFiles();
+
+    Engine::EngineMain engine;
+    engine.mExe = std::make_unique<DiabloExe::DiabloExe>(settings.get<std::string>("Game", "PathEXE"));
+    if (!engine.mExe->isLoaded())
+        return EXIT_FAILURE;
+
+    Engine::ThreadManager threadManager(true);
+    FARender::SpriteLoader spriteLoader(*engine.mExe);
+    spriteLoader.loadMetadataOnly();
+
+    if (enet_initialize() != 0)
+        return EXIT_FAILURE;
+
+    std::cout << fmt::format("{:>7}{:>10}{:>12}{:>12}{:>13}{:>11}{:>13}{:>13}{:>8}{:>13}{:>18}", "clients", "join ms", "tick ms", "max tick ms",
+                             "down B/tick", "up B/tick", "avg latency", "max latency", "lost", "input delay", "spectator B/tick")
+              << std::endl;
+
+    for (size_t clients = 1; clients <= maxClients; clients = clients == maxClients ? clients + 1 : std::min(clients * 2, maxClients))
+    {
+        Result result = runTest(engine, options, clients);
+
+        std::cout << fmt::format("{:>7}{:>10.0f}{:>12.3f}{:>12.3f}{:>13.1f}{:>11.1f}{:>13.2f}{:>13}{:>8}{:>13.2f}{:>18.1f}", result.clients,
+                                 result.joinMilliseconds, result.averageTickMilliseconds, result.maxTickMilliseconds, result.bytesDownPerTick,
+                                 result.bytesUpPerTick, result.averageLatency, result.maxLatency, result.lostInputs, result.averageInputDelay,
+                                 result.spectatorBytesDownPerTick)
+                  << std::endl;
+    }
+
+    // The last server has to go before we shut down enet
+    engine.mMultiplayer.reset();
+    enet_deinitialize();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,252 @@
+#include <algorithm>
+#include <atomic>
+#include <cel/celdecoder.h>
+#include <chrono>
+#include <cstdlib>
+#include <cxxopts.hpp>
+#include <diabloexe/diabloexe.h>
+#include <engine/enginemain.h>
+#include <engine/threadmanager.h>
+#include <faio/faio.h>
+#include <farender/spriteloader.h>
+#include <fasavegame/gameloader.h>
+#include <faworld/gamelevel.h>
+#include <faworld/itemfactory.h>
+#include <faworld/itemmap.h>
+#include <faworld/monster.h>
+#include <faworld/world.h>
+#include <fmt/format.h>
+#include <functional>
+#include <iostream>
+#include <misc/misc.h>
+#include <new>
+#include <random/random.h>
+#include <serial/binarystream.h>
+#include <serial/textstream.h>
+#include <serial/zlibstream.h>
+#include <settings/settings.h>
+
+// Benchmarks World::save and World::load with each of the Serial stream implementations, on a world generated from a fixed seed.
+// Needs the game data to be set up, same as freeablo itself.
+
+static std::atomic<size_t> allocationCount = 0;
+
+void* operator new(size_t size)
+{
+    allocationCount++;
+    if (void* ptr = malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+
+namespace
+{
+    struct StreamImplementation
+    {
+        std::string name;
+        // Saves the world with a new write stream, and returns the data it produced
+        std::function<std::vector<uint8_t>(FAWorld::World& world)> save;
+        // Loads the world from a new read stream over data
+        std::function<void(FAWorld::World& world, const std::vector<uint8_t>& data)> load;
+    };
+
+    struct Measurement
+    {
+        double seconds = 0;
+        size_t allocations = 0;
+    };
+
+    Measurement measure(const std::function<void()>& func)
+    {
+        size_t allocationsBefore = allocationCount;
+        auto start = std::chrono::steady_clock::now();
+
+        func();
+
+        Measurement measurement;
+        measurement.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        measurement.allocations = allocationCount - allocationsBefore;
+        return measurement;
+    }
+
+    std::vector<uint8_t> toVector(std::pair<uint8_t*, size_t> data) { return std::vector<uint8_t>(data.first, data.first + data.second); }
+
+    std::vector<StreamImplementation> getStreamImplementations()
+    {
+        auto binaryFactory = [](const uint8_t* data, size_t size) { return std::make_unique<Serial::BinaryReadStream>(data, size); };
+
+        return {
+            {"text",
+             [](FAWorld::World& world) {
+                 Serial::TextWriteStream stream;
+                 FASaveGame::GameSaver saver(stream);
+                 world.save(saver);
+                 return toVector(stream.getData());
+             },
+             [](FAWorld::World& world, const std::vector<uint8_t>& data) {
+                 Serial::TextReadStream stream(std::string(data.begin(), data.end()));
+                 FASaveGame::GameLoader loader(stream);
+                 world.load(loader);
+             }},
+            {"binary",
+             [](FAWorld::World& world) {
+                 Serial::BinaryWriteStream stream;
+                 FASaveGame::GameSaver saver(stream);
+                 world.save(saver);
+                 return toVector(stream.getData());
+             },
+             [](FAWorld::World& world, const std::vector<uint8_t>& data) {
+                 Serial::BinaryReadStream stream(data.data(), data.size());
+                 FASaveGame::GameLoader loader(stream);
+                 world.load(loader);
+             }},
+            {"zlib",
+             [](FAWorld::World& world) {
+                 Serial::BinaryWriteStream binaryStream;
+                 Serial::ZlibWriteStream stream(binaryStream);
+                 FASaveGame::GameSaver saver(stream);
+                 world.save(saver);
+                 return toVector(stream.getData());
+             },
+             [binaryFactory](FAWorld::World& world, const std::vector<uint8_t>& data) {
+                 Serial::ZlibReadStream stream(data.data(), data.size(), binaryFactory);
+                 FASaveGame::GameLoader loader(stream);
+                 world.load(loader);
+             }},
+        };
+    }
+
+    void populateWorld(FAWorld::World& world, const DiabloExe::DiabloExe& exe, int32_t levels, int32_t monstersPerLevel, int32_t itemsPerLevel)
+    {
+        world.generateLevels();
+
+        Random::Rng& rng = *world.mRng;
+
+        for (int32_t levelIndex = 1; levelIndex <= levels; levelIndex++)
+        {
+            FAWorld::GameLevel& level = *world.getLevel(levelIndex);
+
+            auto randomFreePoint = [&]() {
+                Misc::Point point;
+                do
+                {
+                    point.x = rng.randomInRange(1, level.width() - 1);
+                    point.y = rng.randomInRange(1, level.height() - 1);
+                } while (!level.isPassable(point, nullptr));
+                return point;
+            };
+
+            std::vector<const DiabloExe::Monster*> possibleMonsters = exe.getMonstersInLevel(levelIndex);
+            for (int32_t i = 0; i < monstersPerLevel; i++)
+            {
+                const DiabloExe::Monster* monsterData = possibleMonsters[rng.randomInRange(0, int32_t(possibleMonsters.size()) - 1)];
+                FAWorld::Monster* monster = new FAWorld::Monster(world, *monsterData);
+                monster->teleport(&level, FAWorld::Position(randomFreePoint()));
+            }
+
+            for (int32_t i = 0; i < itemsPerLevel; i++)
+            {
+                std::unique_ptr<FAWorld::Item> item = world.getItemFactory().generateRandomItem(levelIndex, FAWorld::ItemFactory::ItemGenerationType::Normal);
+                while (!level.getItemMap().placeItem(item, randomFreePoint()))
+                    ;
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Misc::saveArgv0(argv[0]);
+
+    cxxopts::Options desc("savebench", "Measures World::save and World::load with each stream implementation");
+    desc.add_options()("h,help", "Print help")("levels", "Number of dungeon levels to generate (1-16)", cxxopts::value<int32_t>()->default_value("16"))(
+        "monsters", "Extra monsters per level, on top of the generated ones", cxxopts::value<int32_t>()->default_value("0"))(
+        "items", "Items on the ground per level", cxxopts::value<int32_t>()->default_value("50"))(
+        "seed", "World seed", cxxopts::value<uint32_t>()->default_value("1234"))(
+        "iterations", "Number of times to repeat each measurement", cxxopts::value<int32_t>()->default_value("5"));
+
+    cxxopts::ParseResult variables;
+    try
+    {
+        variables = desc.parse(argc, argv);
+    }
+    catch (cxxopts::OptionParseException& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl << std::endl;
+        std::cerr << desc.help() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (variables.count("help"))
+    {
+        std::cout << desc.help() << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    int32_t levels = std::clamp(variables["levels"].as<int32_t>(), 1, 16);
+    int32_t iterations = std::max(variables["iterations"].as<int32_t>(), 1);
+
+    Settings::Settings settings;
+    if (!settings.loadUserSettings())
+        return EXIT_FAILURE;
+
+    FAIO::ScopedInitFAIO faioInit(settings.get<std::string>("Game", "PathMPQ"));
+    Cel::CelDecoder::loadConfigFiles();
+
+    DiabloExe::DiabloExe exe(settings.get<std::string>("Game", "PathEXE"));
+    if (!exe.isLoaded())
+        return EXIT_FAILURE;
+
+    // Monsters and items grab their sprites on construction, but nothing gets drawn, so we only need the frame counts
+    Engine::ThreadManager threadManager(true);
+    FARender::SpriteLoader spriteLoader(exe);
+    spriteLoader.loadMetadataOnly();
+
+    Engine::EngineMain engine;
+    engine.mWorld = std::make_unique<FAWorld::World>(exe, variables["seed"].as<uint32_t>());
+    FAWorld::World& world = *engine.mWorld;
+
+    populateWorld(world, exe, levels, variables["monsters"].as<int32_t>(), variables["items"].as<int32_t>());
+
+    std::cout << fmt::format("{:<8}{:>12}{:>10}{:>11}{:>13}{:>10}{:>11}{:>13}", "stream", "bytes", "save ms", "save MB/s", "save allocs", "load ms", "load MB/s",
+                             "load allocs")
+              << std::endl;
+
+    for (const StreamImplementation& implementation : getStreamImplementations())
+    {
+        std::vector<uint8_t> data;
+        Measurement save;
+        Measurement load;
+
+        for (int32_t i = 0; i < iterations; i++)
+        {
+            Measurement thisSave = measure([&]() { data = implementation.save(world); });
+
+            FAWorld::World loadedWorld(exe, 0);
+            Measurement thisLoad = measure([&]() { implementation.load(loadedWorld, data); });
+
+            save.seconds += thisSave.seconds / iterations;
+            save.allocations += thisSave.allocations / iterations;
+            load.seconds += thisLoad.seconds / iterations;
+            load.allocations += thisLoad.allocations / iterations;
+        }
+
+        double megabytes = double(data.size()) / (1024.0 * 1024.0);
+
+        std::cout << fmt::format("{:<8}{:>12}{:>10.2f}{:>11.1f}{:>13}{:>10.2f}{:>11.1f}{:>13}",
+                                 implementation.name,
+                                 data.size(),
+                                 save.seconds * 1000.0,
+                                 megabytes / save.seconds,
+                                 save.allocations,
+                                 load.seconds * 1000.0,
+                                 megabytes / load.seconds,
+                                 load.allocations)
+                  << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
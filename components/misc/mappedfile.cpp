@@ -0,0 +1,91 @@
+#include "mappedfile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Misc
+{
+#ifdef _WIN32
+    MappedFile::MappedFile(const std::string& path)
+    {
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return;
+
+        mFileHandle = file;
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize))
+            return;
+
+        mSize = size_t(fileSize.QuadPart);
+
+        // Mapping an empty file is an error on windows, so just treat it as an open file with no data
+        if (mSize == 0)
+        {
+            mOpen = true;
+            return;
+        }
+
+        mMappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mMappingHandle == nullptr)
+            return;
+
+        mData = reinterpret_cast<const uint8_t*>(MapViewOfFile(mMappingHandle, FILE_MAP_READ, 0, 0, 0));
+        mOpen = mData != nullptr;
+    }
+
+    MappedFile::~MappedFile()
+    {
+        if (mData)
+            UnmapViewOfFile(mData);
+        if (mMappingHandle)
+            CloseHandle(mMappingHandle);
+        if (mFileHandle)
+            CloseHandle(mFileHandle);
+    }
+#else
+    MappedFile::MappedFile(const std::string& path)
+    {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd == -1)
+            return;
+
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) == 0)
+        {
+            mSize = size_t(fileStat.st_size);
+
+            if (mSize == 0)
+            {
+                mOpen = true;
+            }
+            else
+            {
+                void* mapping = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapping != MAP_FAILED)
+                {
+                    mData = reinterpret_cast<const uint8_t*>(mapping);
+                    mOpen = true;
+                }
+            }
+        }
+
+        // the mapping keeps its own reference to the file
+        close(fd);
+    }
+
+    MappedFile::~MappedFile()
+    {
+        if (mData)
+            munmap(const_cast<uint8_t*>(mData), mSize);
+    }
+#endif
+}
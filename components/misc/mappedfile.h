@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Misc
+{
+    // Read-only memory mapping of a whole file. The OS pages the data in as it is accessed,
+    // so nothing is copied into process memory up front.
+    class MappedFile
+    {
+    public:
+        explicit MappedFile(const std::string& path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool isOpen() const { return mOpen; }
+
+        const uint8_t* data() const { return mData; }
+        size_t size() const { return mSize; }
+
+    private:
+        bool mOpen = false;
+        const uint8_t* mData = nullptr;
+        size_t mSize = 0;
+
+#ifdef _WIN32
+        void* mFileHandle = nullptr;
+        void* mMappingHandle = nullptr;
+#endif
+    };
+}
@@ -3,9 +3,10 @@
 #include <filesystem/path.h>
 #include <memory>
 #include <misc/assert.h>
-#include <misc/stringops.h>
+#include <misc/mappedfile.h>
 #include <render/commandqueue.h>
 #include <render/renderinstance.h>
+#include <serial/binarystream.h>
 
 /* Stores many small textures into a large texture (or array of textures)
  * to allow batched drawing commands that increase performance. */
@@ -179,110 +180,127 @@ namespace Render
         }
     }
 
+    // The cache is a single file, so it can be mapped in one go and uploaded straight from the mapping:
+    // U64 index size, index (in Serial binary format), then the raw RGBA data for each layer, each one starting on a CACHE_ALIGNMENT boundary.
+    static uint64_t alignCacheOffset(uint64_t offset)
+    {
+        return ((offset + AtlasTexture::CACHE_ALIGNMENT - 1) / AtlasTexture::CACHE_ALIGNMENT) * AtlasTexture::CACHE_ALIGNMENT;
+    }
+
     void AtlasTexture::saveTexturesToCache(const filesystem::path& atlasPath) const
     {
+        std::vector<std::pair<std::string, Texture*>> layersToSave;
         for (const auto& pair : mLayersByCategory)
         {
-            const std::string& category = pair.first;
-            const Layers& layers = pair.second;
+            for (const auto& layer : pair.second.layers)
+                layersToSave.emplace_back(pair.first, layer.texture.get());
+        }
 
-            filesystem::path destinationFolder = atlasPath / category;
-            if (!filesystem::exists(destinationFolder))
-                release_assert(filesystem::create_directories(destinationFolder));
+        Serial::BinaryWriteStream indexStream;
+        {
+            indexStream.write(uint32_t(layersToSave.size()));
 
-            for (size_t i = 0; i < layers.layers.size(); i++)
+            uint64_t offset = 0;
+            for (const auto& layerToSave : layersToSave)
             {
-                Render::Texture& texture = *layers.layers[i].texture;
-                Image image(texture.width(), texture.height());
+                const Texture& texture = *layerToSave.second;
 
-                texture.readImageData(reinterpret_cast<uint8_t*>(image.mData.data()));
+                indexStream.write(layerToSave.first);
+                indexStream.write(texture.width());
+                indexStream.write(texture.height());
+                indexStream.write(offset);
 
-                std::ostringstream ss;
-                ss << std::setfill('0') << std::setw(2) << i;
+                offset = alignCacheOffset(offset + uint64_t(texture.width()) * uint64_t(texture.height()) * 4);
+            }
+        }
 
-                FILE* f = fopen((destinationFolder / (ss.str() + ".dmp")).str().c_str(), "wb");
+        std::pair<uint8_t*, size_t> indexData = indexStream.getData();
 
-                int32_t sizes[] = {image.width(), image.height()};
-                fwrite(sizes, sizeof(int32_t), 2, f);
-                fwrite(image.mData.data(), 1, image.width() * image.height() * 4, f);
+        Serial::BinaryWriteStream indexSizeStream;
+        indexSizeStream.write(uint64_t(indexData.second));
+        std::pair<uint8_t*, size_t> indexSizeData = indexSizeStream.getData();
 
-                fclose(f);
+        FILE* f = fopen((atlasPath / CACHE_FILENAME).str().c_str(), "wb");
+        release_assert(f);
 
-                // for debugging
-                // Image::saveToPng(image, (destinationFolder / (ss.str() + ".png")).str());
-            }
-        }
-    }
+        // Everything is written sequentially, with explicit zero padding, so we never have to seek (which only takes a 32 bit long on windows)
+        std::vector<uint8_t> padding(CACHE_ALIGNMENT, 0);
+        auto writePadding = [&](uint64_t size, uint64_t paddedSize) { fwrite(padding.data(), 1, size_t(paddedSize - size), f); };
 
-    void AtlasTexture::loadTexturesFromCache(const filesystem::path& atlasPath)
-    {
-        for (auto& categoryEntry : filesystem::directory_iterator(atlasPath))
-        {
-            if (!categoryEntry.path().is_directory())
-                continue;
+        fwrite(indexSizeData.first, 1, indexSizeData.second, f);
+        fwrite(indexData.first, 1, indexData.second, f);
 
-            Layers categoryLayers;
+        uint64_t headerSize = uint64_t(indexSizeData.second) + indexData.second;
+        writePadding(headerSize, alignCacheOffset(headerSize));
 
-            std::string category = categoryEntry.path().filename();
+        Image image;
+        for (const auto& layerToSave : layersToSave)
+        {
+            Texture& texture = *layerToSave.second;
+            image = Image(texture.width(), texture.height());
 
-            std::vector<filesystem::path> sortedFilesToLoad;
-            for (auto& imageEntry : filesystem::directory_iterator(categoryEntry.path()))
-            {
-                if (Misc::StringUtils::getFileExtension(imageEntry.path().filename()) != "dmp")
-                    continue;
-                sortedFilesToLoad.emplace_back(imageEntry.path());
-            }
-            std::sort(sortedFilesToLoad.begin(), sortedFilesToLoad.end());
+            texture.readImageData(reinterpret_cast<uint8_t*>(image.mData.data()));
 
-            for (int32_t i = 0; i < int32_t(sortedFilesToLoad.size()); i++)
-            {
-                std::ostringstream ss;
-                ss << std::setfill('0') << std::setw(2) << i;
+            uint64_t layerSize = uint64_t(image.width()) * uint64_t(image.height()) * 4;
+            fwrite(image.mData.data(), 1, size_t(layerSize), f);
 
-                std::string filename = ss.str() + ".dmp";
+            // pad up to the next alignment boundary, so the next layer (or the end of the file) lands where the index says it does
+            writePadding(layerSize, alignCacheOffset(layerSize));
 
-                if (sortedFilesToLoad[i].filename() != filename)
-                    throw std::runtime_error("missing layer");
-            }
+            // for debugging
+            // Image::saveToPng(image, (atlasPath / (layerToSave.first + ".png")).str());
+        }
 
-            for (auto& path : sortedFilesToLoad)
-            {
-                Image image;
-                {
-                    FILE* f = fopen(path.str().c_str(), "rb");
+        fclose(f);
+    }
+
+    void AtlasTexture::loadTexturesFromCache(const filesystem::path& atlasPath)
+    {
+        Misc::MappedFile file((atlasPath / CACHE_FILENAME).str());
+        if (!file.isOpen())
+            throw std::runtime_error("missing atlas cache");
 
-                    int32_t sizes[] = {0, 0};
-                    fread(sizes, sizeof(int32_t), 2, f);
+        if (file.size() < sizeof(uint64_t))
+            throw std::runtime_error("atlas cache is truncated");
+        uint64_t indexSize = Serial::BinaryReadStream(file.data(), sizeof(uint64_t)).read_uint64_t();
 
-                    if (sizes[0] < 0 || sizes[0] > mInstance.capabilities().maxTextureSize || sizes[1] < 0 ||
-                        sizes[1] > mInstance.capabilities().maxTextureSize)
-                        throw std::runtime_error("Texture is too large");
+        if (indexSize > file.size() - sizeof(uint64_t))
+            throw std::runtime_error("atlas cache is truncated");
 
-                    image = Image(sizes[0], sizes[1]);
-                    fread(image.mData.data(), 1, image.width() * image.height() * 4, f);
+        size_t dataStart = alignCacheOffset(sizeof(uint64_t) + size_t(indexSize));
+        Serial::BinaryReadStream indexStream(file.data() + sizeof(uint64_t), size_t(indexSize));
 
-                    fclose(f);
-                }
+        uint32_t layerCount = indexStream.read_uint32_t();
+        for (uint32_t i = 0; i < layerCount; i++)
+        {
+            std::string category = indexStream.read_string();
+            int32_t width = indexStream.read_int32_t();
+            int32_t height = indexStream.read_int32_t();
+            uint64_t offset = indexStream.read_uint64_t();
 
-                Layer newLayer;
-                {
-                    BaseTextureInfo textureInfo{};
-                    textureInfo.width = image.width();
-                    textureInfo.height = image.height();
-                    textureInfo.arrayLayers = 1;
-                    textureInfo.format = Format::RGBA8UNorm;
-                    textureInfo.minFilter = Filter::Nearest;
-                    textureInfo.magFilter = Filter::Nearest;
-
-                    newLayer.texture = mInstance.createTexture(textureInfo);
-                }
+            if (width < 0 || width > mInstance.capabilities().maxTextureSize || height < 0 || height > mInstance.capabilities().maxTextureSize)
+                throw std::runtime_error("Texture is too large");
 
-                newLayer.texture->updateImageData(0, 0, 0, image.width(), image.height(), reinterpret_cast<const uint8_t*>(image.mData.data()), image.width());
+            if (dataStart + offset + uint64_t(width) * uint64_t(height) * 4 > file.size())
+                throw std::runtime_error("atlas cache is truncated");
 
-                categoryLayers.layers.push_back(std::move(newLayer));
+            Layer newLayer;
+            {
+                BaseTextureInfo textureInfo{};
+                textureInfo.width = width;
+                textureInfo.height = height;
+                textureInfo.arrayLayers = 1;
+                textureInfo.format = Format::RGBA8UNorm;
+                textureInfo.minFilter = Filter::Nearest;
+                textureInfo.magFilter = Filter::Nearest;
+
+                newLayer.texture = mInstance.createTexture(textureInfo);
             }
 
-            mLayersByCategory[category] = std::move(categoryLayers);
+            // upload straight from the mapping, the pixel data is never copied into an Image
+            newLayer.texture->updateImageData(0, 0, 0, width, height, file.data() + dataStart + offset, width);
+
+            mLayersByCategory[category].layers.push_back(std::move(newLayer));
         }
     }
 
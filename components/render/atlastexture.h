@@ -55,6 +55,8 @@ namespace Render
         const std::unordered_map<std::string, Layers>& getLayersByCategory() const { return mLayersByCategory; }
 
         static constexpr int32_t PADDING = 2;
+        static constexpr size_t CACHE_ALIGNMENT = 4096;
+        static constexpr const char* CACHE_FILENAME = "layers.dat";
 
     private:
         std::vector<NonNullConstPtr<TextureReference>> addCategorySprites(const std::string& category, const std::vector<LoadImageData>& images);
@@ -0,0 +1,94 @@
+#include "binarystream.h"
+#include <misc/assert.h>
+#include <type_traits>
+
+namespace Serial
+{
+    template <typename T> T BinaryReadStream::readLittleEndian()
+    {
+        typedef typename std::make_unsigned<T>::type UnsignedT;
+
+        release_assert(mPosition + sizeof(T) <= mSize);
+
+        UnsignedT val = 0;
+        for (size_t i = 0; i < sizeof(T); i++)
+            val = UnsignedT(val | (UnsignedT(mData[mPosition + i]) << (i * 8)));
+
+        mPosition += sizeof(T);
+
+        return T(val);
+    }
+
+    bool BinaryReadStream::read_bool()
+    {
+        uint8_t data = readLittleEndian<uint8_t>();
+        release_assert(data == 0 || data == 1);
+        return data == 1;
+    }
+
+    int64_t BinaryReadStream::read_int64_t() { return readLittleEndian<int64_t>(); }
+
+    uint64_t BinaryReadStream::read_uint64_t() { return readLittleEndian<uint64_t>(); }
+
+    int32_t BinaryReadStream::read_int32_t() { return readLittleEndian<int32_t>(); }
+
+    uint32_t BinaryReadStream::read_uint32_t() { return readLittleEndian<uint32_t>(); }
+
+    int16_t BinaryReadStream::read_int16_t() { return readLittleEndian<int16_t>(); }
+
+    uint16_t BinaryReadStream::read_uint16_t() { return readLittleEndian<uint16_t>(); }
+
+    int8_t BinaryReadStream::read_int8_t() { return readLittleEndian<int8_t>(); }
+
+    uint8_t BinaryReadStream::read_uint8_t() { return readLittleEndian<uint8_t>(); }
+
+    std::string BinaryReadStream::read_string()
+    {
+        uint32_t size = readLittleEndian<uint32_t>();
+        release_assert(mPosition + size <= mSize);
+
+        std::string retval(reinterpret_cast<const char*>(mData + mPosition), size);
+        mPosition += size;
+
+        return retval;
+    }
+
+    size_t BinaryWriteStream::getCurrentSize() const { return mData.size(); }
+
+    void BinaryWriteStream::resize(size_t size) { mData.resize(size); }
+
+    std::pair<uint8_t*, size_t> BinaryWriteStream::getData() { return std::make_pair(mData.data(), mData.size()); }
+
+    template <typename T> void BinaryWriteStream::writeLittleEndian(T val)
+    {
+        typedef typename std::make_unsigned<T>::type UnsignedT;
+
+        UnsignedT unsignedVal = UnsignedT(val);
+        for (size_t i = 0; i < sizeof(T); i++)
+            mData.push_back(uint8_t(unsignedVal >> (i * 8)));
+    }
+
+    void BinaryWriteStream::write(bool val) { writeLittleEndian<uint8_t>(val ? 1 : 0); }
+
+    void BinaryWriteStream::write(int64_t val) { writeLittleEndian(val); }
+
+    void BinaryWriteStream::write(uint64_t val) { writeLittleEndian(val); }
+
+    void BinaryWriteStream::write(int32_t val) { writeLittleEndian(val); }
+
+    void BinaryWriteStream::write(uint32_t val) { writeLittleEndian(val); }
+
+    void BinaryWriteStream::write(int16_t val) { writeLittleEndian(val); }
+
+    void BinaryWriteStream::write(uint16_t val) { writeLittleEndian(val); }
+
+    void BinaryWriteStream::write(int8_t val) { writeLittleEndian(val); }
+
+    void BinaryWriteStream::write(uint8_t val) { writeLittleEndian(val); }
+
+    void BinaryWriteStream::write(const std::string& val)
+    {
+        writeLittleEndian(uint32_t(val.size()));
+        mData.insert(mData.end(), val.begin(), val.end());
+    }
+}
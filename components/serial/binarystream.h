@@ -0,0 +1,65 @@
+#pragma once
+#include "streaminterface.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Serial
+{
+    // Compact little-endian binary format. Values are written with no type tags, and strings are prefixed with their length as a U32.
+    // Categories are not written at all, so unlike the text format, this stream can't catch mismatched save / load code.
+    class BinaryReadStream : public ReadStreamInterface
+    {
+    public:
+        // Does not take ownership of, or copy data, so it must outlive the stream
+        BinaryReadStream(const uint8_t* data, size_t size) : mData(data), mSize(size) {}
+
+        virtual bool read_bool() override;
+        virtual int64_t read_int64_t() override;
+        virtual uint64_t read_uint64_t() override;
+        virtual int32_t read_int32_t() override;
+        virtual uint32_t read_uint32_t() override;
+        virtual int16_t read_int16_t() override;
+        virtual uint16_t read_uint16_t() override;
+        virtual int8_t read_int8_t() override;
+        virtual uint8_t read_uint8_t() override;
+        virtual std::string read_string() override;
+
+        virtual bool isAtEnd() override { return mPosition == mSize; }
+
+        size_t getPosition() const { return mPosition; }
+
+    private:
+        template <typename T> T readLittleEndian();
+
+        const uint8_t* mData = nullptr;
+        size_t mSize = 0;
+        size_t mPosition = 0;
+    };
+
+    class BinaryWriteStream : public WriteStreamInterface
+    {
+    public:
+        BinaryWriteStream() = default;
+
+        virtual size_t getCurrentSize() const override;
+        virtual void resize(size_t size) override;
+        virtual std::pair<uint8_t*, size_t> getData() override;
+
+        virtual void write(bool val) override;
+        virtual void write(int64_t val) override;
+        virtual void write(uint64_t val) override;
+        virtual void write(int32_t val) override;
+        virtual void write(uint32_t val) override;
+        virtual void write(int16_t val) override;
+        virtual void write(uint16_t val) override;
+        virtual void write(int8_t val) override;
+        virtual void write(uint8_t val) override;
+        virtual void write(const std::string& val) override;
+
+    private:
+        template <typename T> void writeLittleEndian(T val);
+
+        std::vector<uint8_t> mData;
+    };
+}
@@ -0,0 +1,55 @@
+#include "hashstream.h"
+#include <misc/assert.h>
+#include <type_traits>
+
+namespace Serial
+{
+    void HashWriteStream::resize(size_t) { message_and_abort("HashWriteStream does not support resize"); }
+
+    std::pair<uint8_t*, size_t> HashWriteStream::getData()
+    {
+        message_and_abort("HashWriteStream does not keep its data, use getHash()");
+        return std::make_pair(nullptr, 0);
+    }
+
+    void HashWriteStream::hashByte(uint8_t byte)
+    {
+        mHash ^= byte;
+        mHash *= FNV_PRIME;
+        mSize++;
+    }
+
+    template <typename T> void HashWriteStream::hashLittleEndian(T val)
+    {
+        typedef typename std::make_unsigned<T>::type UnsignedT;
+
+        UnsignedT unsignedVal = UnsignedT(val);
+        for (size_t i = 0; i < sizeof(T); i++)
+            hashByte(uint8_t(unsignedVal >> (i * 8)));
+    }
+
+    void HashWriteStream::write(bool val) { hashLittleEndian<uint8_t>(val ? 1 : 0); }
+
+    void HashWriteStream::write(int64_t val) { hashLittleEndian(val); }
+
+    void HashWriteStream::write(uint64_t val) { hashLittleEndian(val); }
+
+    void HashWriteStream::write(int32_t val) { hashLittleEndian(val); }
+
+    void HashWriteStream::write(uint32_t val) { hashLittleEndian(val); }
+
+    void HashWriteStream::write(int16_t val) { hashLittleEndian(val); }
+
+    void HashWriteStream::write(uint16_t val) { hashLittleEndian(val); }
+
+    void HashWriteStream::write(int8_t val) { hashLittleEndian(val); }
+
+    void HashWriteStream::write(uint8_t val) { hashLittleEndian(val); }
+
+    void HashWriteStream::write(const std::string& val)
+    {
+        hashLittleEndian(uint32_t(val.size()));
+        for (char c : val)
+            hashByte(uint8_t(c));
+    }
+}
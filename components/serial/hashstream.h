@@ -0,0 +1,44 @@
+#pragma once
+#include "streaminterface.h"
+#include <cstdint>
+#include <string>
+
+namespace Serial
+{
+    // Feeds everything written to it into a 64 bit FNV-1a hash, without storing any of it.
+    // Values are hashed in the same byte layout BinaryWriteStream would write them in, so two objects that save
+    // identical binary data will always produce the same hash. Categories are ignored.
+    class HashWriteStream : public WriteStreamInterface
+    {
+    public:
+        HashWriteStream() = default;
+
+        uint64_t getHash() const { return mHash; }
+
+        // Number of bytes hashed so far
+        virtual size_t getCurrentSize() const override { return mSize; }
+        virtual void resize(size_t size) override;
+        virtual std::pair<uint8_t*, size_t> getData() override;
+
+        virtual void write(bool val) override;
+        virtual void write(int64_t val) override;
+        virtual void write(uint64_t val) override;
+        virtual void write(int32_t val) override;
+        virtual void write(uint32_t val) override;
+        virtual void write(int16_t val) override;
+        virtual void write(uint16_t val) override;
+        virtual void write(int8_t val) override;
+        virtual void write(uint8_t val) override;
+        virtual void write(const std::string& val) override;
+
+    private:
+        template <typename T> void hashLittleEndian(T val);
+        void hashByte(uint8_t byte);
+
+        static constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+        static constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+        uint64_t mHash = FNV_OFFSET_BASIS;
+        size_t mSize = 0;
+    };
+}
@@ -8,7 +8,7 @@ namespace Serial
     class ReadStreamInterface;
     class WriteStreamInterface;
 
-    static constexpr uint32_t CurrentSaveVersion = 3u;
+    static constexpr uint32_t CurrentSaveVersion = 4u;
 
     // In future, this will be different, and any changes to the save format wothing the range min-(current-1)
     // will be supported by special backward compat code. For now though, it's not worth the overhead, and noone's
@@ -0,0 +1,126 @@
+#include "packedstream.h"
+#include <limits>
+#include <misc/assert.h>
+#include <type_traits>
+
+namespace Serial
+{
+    uint8_t PackedReadStream::readByte()
+    {
+        release_assert(mPosition < mSize);
+        return mData[mPosition++];
+    }
+
+    template <typename T> T PackedReadStream::readUnsigned()
+    {
+        static_assert(std::is_unsigned<T>::value, "");
+
+        uint64_t val = 0;
+        for (uint32_t shift = 0;; shift += 7)
+        {
+            release_assert(shift < sizeof(T) * 8);
+
+            uint8_t byte = readByte();
+            val |= uint64_t(byte & 0x7f) << shift;
+
+            if (!(byte & 0x80))
+                break;
+        }
+
+        release_assert(val <= std::numeric_limits<T>::max());
+        return T(val);
+    }
+
+    template <typename T> T PackedReadStream::readSigned()
+    {
+        typedef typename std::make_unsigned<T>::type UnsignedT;
+
+        // undo the zigzag encoding, see PackedWriteStream::writeSigned()
+        UnsignedT val = readUnsigned<UnsignedT>();
+        return T((val >> 1) ^ (~(val & 1) + 1));
+    }
+
+    bool PackedReadStream::read_bool()
+    {
+        uint8_t data = readByte();
+        release_assert(data == 0 || data == 1);
+        return data == 1;
+    }
+
+    int64_t PackedReadStream::read_int64_t() { return readSigned<int64_t>(); }
+
+    uint64_t PackedReadStream::read_uint64_t() { return readUnsigned<uint64_t>(); }
+
+    int32_t PackedReadStream::read_int32_t() { return readSigned<int32_t>(); }
+
+    uint32_t PackedReadStream::read_uint32_t() { return readUnsigned<uint32_t>(); }
+
+    int16_t PackedReadStream::read_int16_t() { return readSigned<int16_t>(); }
+
+    uint16_t PackedReadStream::read_uint16_t() { return readUnsigned<uint16_t>(); }
+
+    int8_t PackedReadStream::read_int8_t() { return int8_t(readByte()); }
+
+    uint8_t PackedReadStream::read_uint8_t() { return readByte(); }
+
+    std::string PackedReadStream::read_string()
+    {
+        uint32_t size = readUnsigned<uint32_t>();
+        release_assert(mPosition + size <= mSize);
+
+        std::string retval(reinterpret_cast<const char*>(mData + mPosition), size);
+        mPosition += size;
+
+        return retval;
+    }
+
+    size_t PackedWriteStream::getCurrentSize() const { return mData.size(); }
+
+    void PackedWriteStream::resize(size_t size) { mData.resize(size); }
+
+    std::pair<uint8_t*, size_t> PackedWriteStream::getData() { return std::make_pair(mData.data(), mData.size()); }
+
+    void PackedWriteStream::writeUnsigned(uint64_t val)
+    {
+        while (val >= 0x80)
+        {
+            mData.push_back(uint8_t(val | 0x80));
+            val >>= 7;
+        }
+
+        mData.push_back(uint8_t(val));
+    }
+
+    template <typename T> void PackedWriteStream::writeSigned(T val)
+    {
+        typedef typename std::make_unsigned<T>::type UnsignedT;
+
+        // zigzag encoding, maps 0, -1, 1, -2, 2... to 0, 1, 2, 3, 4...
+        UnsignedT unsignedVal = UnsignedT(val);
+        writeUnsigned(UnsignedT(unsignedVal << 1) ^ UnsignedT(val < 0 ? ~UnsignedT(0) : 0));
+    }
+
+    void PackedWriteStream::write(bool val) { mData.push_back(val ? 1 : 0); }
+
+    void PackedWriteStream::write(int64_t val) { writeSigned(val); }
+
+    void PackedWriteStream::write(uint64_t val) { writeUnsigned(val); }
+
+    void PackedWriteStream::write(int32_t val) { writeSigned(val); }
+
+    void PackedWriteStream::write(uint32_t val) { writeUnsigned(val); }
+
+    void PackedWriteStream::write(int16_t val) { writeSigned(val); }
+
+    void PackedWriteStream::write(uint16_t val) { writeUnsigned(val); }
+
+    void PackedWriteStream::write(int8_t val) { mData.push_back(uint8_t(val)); }
+
+    void PackedWriteStream::write(uint8_t val) { mData.push_back(val); }
+
+    void PackedWriteStream::write(const std::string& val)
+    {
+        writeUnsigned(uint32_t(val.size()));
+        mData.insert(mData.end(), val.begin(), val.end());
+    }
+}
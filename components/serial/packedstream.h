@@ -0,0 +1,70 @@
+#pragma once
+#include "streaminterface.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Serial
+{
+    // Variable length binary format, for network packets where every byte counts. Integers wider than a byte are written as LEB128 varints,
+    // seven bits per byte, so small values (tile coordinates, actor ids, counts) take one or two bytes whatever their type.
+    // Signed values are zigzag encoded first, so small negative values are small too. Bytes and bools take a single byte,
+    // and strings are prefixed with their length as a varint. Like the binary format, categories are not written.
+    class PackedReadStream : public ReadStreamInterface
+    {
+    public:
+        // Does not take ownership of, or copy data, so it must outlive the stream
+        PackedReadStream(const uint8_t* data, size_t size) : mData(data), mSize(size) {}
+
+        virtual bool read_bool() override;
+        virtual int64_t read_int64_t() override;
+        virtual uint64_t read_uint64_t() override;
+        virtual int32_t read_int32_t() override;
+        virtual uint32_t read_uint32_t() override;
+        virtual int16_t read_int16_t() override;
+        virtual uint16_t read_uint16_t() override;
+        virtual int8_t read_int8_t() override;
+        virtual uint8_t read_uint8_t() override;
+        virtual std::string read_string() override;
+
+        virtual bool isAtEnd() override { return mPosition == mSize; }
+
+        size_t getPosition() const { return mPosition; }
+
+    private:
+        uint8_t readByte();
+        template <typename T> T readUnsigned();
+        template <typename T> T readSigned();
+
+        const uint8_t* mData = nullptr;
+        size_t mSize = 0;
+        size_t mPosition = 0;
+    };
+
+    class PackedWriteStream : public WriteStreamInterface
+    {
+    public:
+        PackedWriteStream() = default;
+
+        virtual size_t getCurrentSize() const override;
+        virtual void resize(size_t size) override;
+        virtual std::pair<uint8_t*, size_t> getData() override;
+
+        virtual void write(bool val) override;
+        virtual void write(int64_t val) override;
+        virtual void write(uint64_t val) override;
+        virtual void write(int32_t val) override;
+        virtual void write(uint32_t val) override;
+        virtual void write(int16_t val) override;
+        virtual void write(uint16_t val) override;
+        virtual void write(int8_t val) override;
+        virtual void write(uint8_t val) override;
+        virtual void write(const std::string& val) override;
+
+    private:
+        void writeUnsigned(uint64_t val);
+        template <typename T> void writeSigned(T val);
+
+        std::vector<uint8_t> mData;
+    };
+}
@@ -20,6 +20,9 @@ namespace Serial
         virtual uint8_t read_uint8_t() = 0;
         virtual std::string read_string() = 0;
 
+        // true when all data has been consumed
+        virtual bool isAtEnd() = 0;
+
         virtual void startCategory(const std::string& name) { UNUSED_PARAM(name); }
         virtual void endCategory(const std::string& name) { UNUSED_PARAM(name); }
     };
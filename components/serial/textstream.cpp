@@ -1,129 +1,94 @@
 #include "textstream.h"
+#include <algorithm>
+#include <charconv>
 #include <misc/assert.h>
-#include <misc/stringops.h>
 
 namespace Serial
 {
-    std::string TextReadStream::readTypedLine(const std::string& expectedType)
+    std::string_view TextReadStream::readTypedLine(std::string_view expectedType)
     {
-        mLine++;
-        std::string line;
-        std::getline(mData, line);
+        bool expectingCategory = expectedType == "CATEGORY" || expectedType == "CATEGORY_END";
 
-        line.erase(0, line.find_first_not_of(" "));
+        while (true)
+        {
+            mLine++;
+
+            size_t lineEnd = std::min(mData.find('\n', mPosition), mData.size());
+            std::string_view line = std::string_view(mData).substr(mPosition, lineEnd - mPosition);
+            mPosition = std::min(lineEnd + 1, mData.size());
 
-        std::vector<std::string> data = Misc::StringUtils::split(line, ' ');
+            line.remove_prefix(std::min(line.find_first_not_of(' '), line.size()));
 
-        release_assert(data.size() == 2);
+            size_t separator = line.find(' ');
+            release_assert(separator != std::string_view::npos && line.find(' ', separator + 1) == std::string_view::npos);
 
-        if (data[0] == "CATEGORY" || data[0] == "CATEGORY_END")
-            return readTypedLine(expectedType); // ignore
+            std::string_view type = line.substr(0, separator);
 
-        release_assert(data[0] == expectedType);
+            // Categories are only there to make the file easier to read, so skip them unless we were asked for one
+            if (!expectingCategory && (type == "CATEGORY" || type == "CATEGORY_END"))
+                continue;
 
-        return std::string(std::move(data[1]));
+            release_assert(type == expectedType);
+
+            return line.substr(separator + 1);
+        }
     }
 
-    template <typename T> T fromString(const std::string& str)
+    template <typename T> T fromString(std::string_view str)
     {
-        std::istringstream iss;
-        iss.str(str);
-        T retval;
-        iss >> retval;
+        T retval = 0;
+        std::from_chars_result result = std::from_chars(str.data(), str.data() + str.size(), retval);
+        release_assert(result.ec == std::errc() && result.ptr == str.data() + str.size());
         return retval;
     }
 
     bool TextReadStream::read_bool()
     {
-        std::string data = readTypedLine("BOOL");
+        std::string_view data = readTypedLine("BOOL");
         release_assert(data == "true" || data == "false");
         return data == "true";
     }
 
-    int64_t TextReadStream::read_int64_t()
-    {
-        std::string data = readTypedLine("I64");
-        return fromString<int64_t>(data);
-    }
+    int64_t TextReadStream::read_int64_t() { return fromString<int64_t>(readTypedLine("I64")); }
 
-    uint64_t TextReadStream::read_uint64_t()
-    {
-        std::string data = readTypedLine("U64");
-        return fromString<uint64_t>(data);
-    }
+    uint64_t TextReadStream::read_uint64_t() { return fromString<uint64_t>(readTypedLine("U64")); }
 
-    int32_t TextReadStream::read_int32_t()
-    {
-        std::string data = readTypedLine("I32");
-        return fromString<int32_t>(data);
-    }
+    int32_t TextReadStream::read_int32_t() { return fromString<int32_t>(readTypedLine("I32")); }
 
-    uint32_t TextReadStream::read_uint32_t()
-    {
-        std::string data = readTypedLine("U32");
-        return fromString<uint32_t>(data);
-    }
+    uint32_t TextReadStream::read_uint32_t() { return fromString<uint32_t>(readTypedLine("U32")); }
 
-    int16_t TextReadStream::read_int16_t()
-    {
-        std::string data = readTypedLine("I16");
-        return fromString<int16_t>(data);
-    }
+    int16_t TextReadStream::read_int16_t() { return fromString<int16_t>(readTypedLine("I16")); }
 
-    uint16_t TextReadStream::read_uint16_t()
-    {
-        std::string data = readTypedLine("U16");
-        return fromString<uint16_t>(data);
-    }
+    uint16_t TextReadStream::read_uint16_t() { return fromString<uint16_t>(readTypedLine("U16")); }
 
-    int8_t TextReadStream::read_int8_t()
-    {
-        std::string data = readTypedLine("I8");
-        return fromString<int32_t>(data); // use 32 here to stop it being interpreted as char
-    }
+    int8_t TextReadStream::read_int8_t() { return fromString<int8_t>(readTypedLine("I8")); }
 
-    uint8_t TextReadStream::read_uint8_t()
-    {
-        std::string data = readTypedLine("U8");
-        return fromString<uint32_t>(data); // use 32 here to stop it being interpreted as char
-    }
+    uint8_t TextReadStream::read_uint8_t() { return fromString<uint8_t>(readTypedLine("U8")); }
 
     std::string TextReadStream::read_string()
     {
-        std::string sizeData = readTypedLine("STRING");
-        uint32_t size = fromString<uint32_t>(sizeData);
+        uint32_t size = fromString<uint32_t>(readTypedLine("STRING"));
 
-        mData >> std::noskipws;
+        release_assert(size < mData.size() - mPosition && mData[mPosition + size] == '\n'); // trailing newline
 
-        std::string tmp;
-        char c;
-        for (uint32_t i = 0; i < size; i++)
-        {
-            mData >> c;
-            tmp += c;
+        std::string retval = mData.substr(mPosition, size);
+        mLine += uint32_t(std::count(retval.begin(), retval.end(), '\n')) + 1;
+        mPosition += size + 1;
 
-            if (c == '\n')
-                mLine++;
-        }
-
-        mData >> c;
-        release_assert(c == '\n'); // trailing newline
-        mLine++;
-
-        mData >> std::skipws;
-
-        return tmp;
+        return retval;
     }
 
+    bool TextReadStream::isAtEnd() { return mPosition == mData.size(); }
+
     void TextReadStream::startCategory(const std::string& name)
     {
-        std::string data = readTypedLine("CATEGORY");
+        std::string_view data = readTypedLine("CATEGORY");
         release_assert(name == data);
     }
 
     void TextReadStream::endCategory(const std::string& name)
     {
-        std::string data = readTypedLine("CATEGORY_END");
+        std::string_view data = readTypedLine("CATEGORY_END");
         release_assert(name == data);
     }
 
@@ -3,13 +3,15 @@
 #include <limits>
 #include <sstream>
 #include <string>
+#include <string_view>
 
 namespace Serial
 {
+    // Parses values straight out of the buffer, the only allocations are for the strings returned by read_string()
     class TextReadStream : public ReadStreamInterface
     {
     public:
-        TextReadStream(const std::string& data) : mData(data) {}
+        TextReadStream(std::string data) : mData(std::move(data)) {}
 
         virtual bool read_bool() override;
         virtual int64_t read_int64_t() override;
@@ -22,14 +24,17 @@ namespace Serial
         virtual uint8_t read_uint8_t() override;
         virtual std::string read_string() override;
 
+        virtual bool isAtEnd() override;
+
         virtual void startCategory(const std::string& name) override;
         virtual void endCategory(const std::string& name) override;
 
     private:
-        std::string readTypedLine(const std::string& expectedType);
+        std::string_view readTypedLine(std::string_view expectedType);
 
         uint32_t mLine = 0;
-        std::istringstream mData;
+        std::string mData;
+        size_t mPosition = 0;
     };
 
     class TextWriteStream : public WriteStreamInterface
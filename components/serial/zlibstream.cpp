@@ -0,0 +1,237 @@
+#include "zlibstream.h"
+#include <misc/assert.h>
+#include <zlib.h>
+
+namespace Serial
+{
+    namespace
+    {
+        constexpr size_t CHUNK_HEADER_SIZE = sizeof(uint32_t) * 2;
+
+        void writeU32(uint8_t* dest, uint32_t val)
+        {
+            for (size_t i = 0; i < sizeof(uint32_t); i++)
+                dest[i] = uint8_t(val >> (i * 8));
+        }
+
+        uint32_t readU32(const uint8_t* src)
+        {
+            uint32_t val = 0;
+            for (size_t i = 0; i < sizeof(uint32_t); i++)
+                val |= uint32_t(src[i]) << (i * 8);
+            return val;
+        }
+    }
+
+    ZlibWriteStream::ZlibWriteStream(WriteStreamInterface& inner, bool deferCompression)
+        : mInner(inner), mZStream(std::make_unique<z_stream_s>()), mDeferCompression(deferCompression)
+    {
+        *mZStream = {};
+        release_assert(deflateInit(mZStream.get(), Z_DEFAULT_COMPRESSION) == Z_OK);
+    }
+
+    ZlibWriteStream::~ZlibWriteStream() { deflateEnd(mZStream.get()); }
+
+    void ZlibWriteStream::finish()
+    {
+        if (mFinished)
+            return;
+
+        for (const auto& chunk : mDeferredChunks)
+            compressChunk(chunk.data(), chunk.size(), false);
+        mDeferredChunks.clear();
+
+        std::pair<uint8_t*, size_t> data = mInner.getData();
+        compressChunk(data.first, data.second, true);
+        mInner.resize(0);
+
+        mFinished = true;
+    }
+
+    void ZlibWriteStream::endChunk()
+    {
+        std::pair<uint8_t*, size_t> data = mInner.getData();
+
+        if (mDeferCompression)
+            mDeferredChunks.emplace_back(data.first, data.first + data.second);
+        else
+            compressChunk(data.first, data.second, false);
+
+        mInner.resize(0);
+    }
+
+    void ZlibWriteStream::compressChunk(const uint8_t* data, size_t size, bool final)
+    {
+        size_t headerPosition = mCompressed.size();
+        mCompressed.resize(headerPosition + CHUNK_HEADER_SIZE);
+        size_t compressedStart = mCompressed.size();
+
+        mZStream->next_in = const_cast<uint8_t*>(data);
+        mZStream->avail_in = uInt(size);
+
+        // Z_SYNC_FLUSH aligns the compressed output to a byte boundary, so each chunk can be fed to inflate separately.
+        // We keep the same deflate stream for all chunks though, so we still get to use the dictionary from previous chunks.
+        int flush = final ? Z_FINISH : Z_SYNC_FLUSH;
+        size_t outputStep = deflateBound(mZStream.get(), uLong(size)) + 64;
+
+        do
+        {
+            size_t outputStart = mCompressed.size();
+            mCompressed.resize(outputStart + outputStep);
+
+            mZStream->next_out = mCompressed.data() + outputStart;
+            mZStream->avail_out = uInt(outputStep);
+
+            int result = deflate(mZStream.get(), flush);
+            release_assert(result == Z_OK || result == Z_STREAM_END || result == Z_BUF_ERROR);
+
+            mCompressed.resize(outputStart + outputStep - mZStream->avail_out);
+        } while (mZStream->avail_out == 0);
+
+        release_assert(mZStream->avail_in == 0);
+
+        writeU32(mCompressed.data() + headerPosition, uint32_t(size));
+        writeU32(mCompressed.data() + headerPosition + sizeof(uint32_t), uint32_t(mCompressed.size() - compressedStart));
+    }
+
+    size_t ZlibWriteStream::getCurrentSize() const { return mCompressed.size(); }
+
+    void ZlibWriteStream::resize(size_t) { message_and_abort("ZlibWriteStream does not support resize"); }
+
+    std::pair<uint8_t*, size_t> ZlibWriteStream::getData()
+    {
+        finish();
+        return std::make_pair(mCompressed.data(), mCompressed.size());
+    }
+
+    template <typename T> void ZlibWriteStream::forward(const T& val)
+    {
+        release_assert(!mFinished);
+
+        mInner.write(val);
+
+        if (mInner.getCurrentSize() >= CHUNK_SIZE)
+            endChunk();
+    }
+
+    void ZlibWriteStream::write(bool val) { forward(val); }
+
+    void ZlibWriteStream::write(int64_t val) { forward(val); }
+
+    void ZlibWriteStream::write(uint64_t val) { forward(val); }
+
+    void ZlibWriteStream::write(int32_t val) { forward(val); }
+
+    void ZlibWriteStream::write(uint32_t val) { forward(val); }
+
+    void ZlibWriteStream::write(int16_t val) { forward(val); }
+
+    void ZlibWriteStream::write(uint16_t val) { forward(val); }
+
+    void ZlibWriteStream::write(int8_t val) { forward(val); }
+
+    void ZlibWriteStream::write(uint8_t val) { forward(val); }
+
+    void ZlibWriteStream::write(const std::string& val) { forward(val); }
+
+    void ZlibWriteStream::startCategory(const std::string& name)
+    {
+        release_assert(!mFinished);
+        mInner.startCategory(name);
+    }
+
+    void ZlibWriteStream::endCategory(const std::string& name)
+    {
+        release_assert(!mFinished);
+        mInner.endCategory(name);
+    }
+
+    ZlibReadStream::ZlibReadStream(const uint8_t* data, size_t size, InnerStreamFactory innerStreamFactory)
+        : mData(data), mSize(size), mInnerStreamFactory(std::move(innerStreamFactory)), mZStream(std::make_unique<z_stream_s>())
+    {
+        *mZStream = {};
+        release_assert(inflateInit(mZStream.get()) == Z_OK);
+    }
+
+    ZlibReadStream::~ZlibReadStream() { inflateEnd(mZStream.get()); }
+
+    bool ZlibReadStream::decompressNextChunk()
+    {
+        if (mPosition == mSize)
+            return false;
+
+        release_assert(mPosition + CHUNK_HEADER_SIZE <= mSize);
+        uint32_t uncompressedSize = readU32(mData + mPosition);
+        uint32_t compressedSize = readU32(mData + mPosition + sizeof(uint32_t));
+        mPosition += CHUNK_HEADER_SIZE;
+
+        release_assert(mPosition + compressedSize <= mSize);
+
+        // one extra byte so we never pass a zero-sized output buffer to inflate (the last chunk can be empty)
+        mChunk.resize(uncompressedSize + 1);
+
+        mZStream->next_in = const_cast<uint8_t*>(mData + mPosition);
+        mZStream->avail_in = compressedSize;
+        mZStream->next_out = mChunk.data();
+        mZStream->avail_out = uInt(mChunk.size());
+
+        int result = inflate(mZStream.get(), Z_SYNC_FLUSH);
+        release_assert(result == Z_OK || result == Z_STREAM_END);
+        release_assert(mZStream->avail_in == 0);
+        release_assert(mZStream->avail_out == 1);
+
+        mPosition += compressedSize;
+        mInner = mInnerStreamFactory(mChunk.data(), uncompressedSize);
+
+        return true;
+    }
+
+    bool ZlibReadStream::isAtEnd()
+    {
+        while (!mInner || mInner->isAtEnd())
+        {
+            if (!decompressNextChunk())
+                return true;
+        }
+
+        return false;
+    }
+
+    ReadStreamInterface& ZlibReadStream::inner()
+    {
+        release_assert(!isAtEnd());
+        return *mInner;
+    }
+
+    bool ZlibReadStream::read_bool() { return inner().read_bool(); }
+
+    int64_t ZlibReadStream::read_int64_t() { return inner().read_int64_t(); }
+
+    uint64_t ZlibReadStream::read_uint64_t() { return inner().read_uint64_t(); }
+
+    int32_t ZlibReadStream::read_int32_t() { return inner().read_int32_t(); }
+
+    uint32_t ZlibReadStream::read_uint32_t() { return inner().read_uint32_t(); }
+
+    int16_t ZlibReadStream::read_int16_t() { return inner().read_int16_t(); }
+
+    uint16_t ZlibReadStream::read_uint16_t() { return inner().read_uint16_t(); }
+
+    int8_t ZlibReadStream::read_int8_t() { return inner().read_int8_t(); }
+
+    uint8_t ZlibReadStream::read_uint8_t() { return inner().read_uint8_t(); }
+
+    std::string ZlibReadStream::read_string() { return inner().read_string(); }
+
+    void ZlibReadStream::startCategory(const std::string& name)
+    {
+        if (!isAtEnd())
+            mInner->startCategory(name);
+    }
+
+    void ZlibReadStream::endCategory(const std::string& name)
+    {
+        if (!isAtEnd())
+            mInner->endCategory(name);
+    }
+}
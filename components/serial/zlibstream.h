@@ -0,0 +1,104 @@
+#pragma once
+#include "streaminterface.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct z_stream_s;
+
+namespace Serial
+{
+    // Compresses the output of another write stream with deflate. Every CHUNK_SIZE bytes or so, the data written so far into the inner stream
+    // is compressed and the inner stream is cleared, so the full uncompressed data never has to be held in memory at once.
+    // Chunks are only ever cut between values, so each decompressed chunk can be parsed on its own by the matching read stream.
+    // Output format is a sequence of chunks, each one being: U32 uncompressed size, U32 compressed size, compressed data.
+    // With deferCompression set, chunks are just moved out of the inner stream and kept uncompressed until finish() is called,
+    // which lets the (cheap) serialisation happen on one thread and the (expensive) compression on another.
+    class ZlibWriteStream : public WriteStreamInterface
+    {
+    public:
+        explicit ZlibWriteStream(WriteStreamInterface& inner, bool deferCompression = false);
+        ~ZlibWriteStream();
+
+        // Compresses any remaining data, after this the stream can't be written to anymore
+        void finish();
+
+        // Size of the compressed data so far
+        virtual size_t getCurrentSize() const override;
+        virtual void resize(size_t size) override;
+        // Returns the compressed data, calls finish() if it hasn't been called yet
+        virtual std::pair<uint8_t*, size_t> getData() override;
+
+        virtual void write(bool val) override;
+        virtual void write(int64_t val) override;
+        virtual void write(uint64_t val) override;
+        virtual void write(int32_t val) override;
+        virtual void write(uint32_t val) override;
+        virtual void write(int16_t val) override;
+        virtual void write(uint16_t val) override;
+        virtual void write(int8_t val) override;
+        virtual void write(uint8_t val) override;
+        virtual void write(const std::string& val) override;
+
+        virtual void startCategory(const std::string& name) override;
+        virtual void endCategory(const std::string& name) override;
+
+        static constexpr size_t CHUNK_SIZE = 256 * 1024;
+
+    private:
+        template <typename T> void forward(const T& val);
+        void endChunk();
+        void compressChunk(const uint8_t* data, size_t size, bool final);
+
+        WriteStreamInterface& mInner;
+        std::unique_ptr<z_stream_s> mZStream;
+        std::vector<uint8_t> mCompressed;
+        bool mFinished = false;
+
+        bool mDeferCompression = false;
+        std::vector<std::vector<uint8_t>> mDeferredChunks;
+    };
+
+    // Reads data written by ZlibWriteStream. Each chunk is decompressed when the previous one has been fully read,
+    // and parsed by a new inner stream created with the supplied factory.
+    class ZlibReadStream : public ReadStreamInterface
+    {
+    public:
+        typedef std::function<std::unique_ptr<ReadStreamInterface>(const uint8_t* data, size_t size)> InnerStreamFactory;
+
+        // Does not take ownership of, or copy data, so it must outlive the stream
+        ZlibReadStream(const uint8_t* data, size_t size, InnerStreamFactory innerStreamFactory);
+        ~ZlibReadStream();
+
+        virtual bool read_bool() override;
+        virtual int64_t read_int64_t() override;
+        virtual uint64_t read_uint64_t() override;
+        virtual int32_t read_int32_t() override;
+        virtual uint32_t read_uint32_t() override;
+        virtual int16_t read_int16_t() override;
+        virtual uint16_t read_uint16_t() override;
+        virtual int8_t read_int8_t() override;
+        virtual uint8_t read_uint8_t() override;
+        virtual std::string read_string() override;
+
+        virtual bool isAtEnd() override;
+
+        virtual void startCategory(const std::string& name) override;
+        virtual void endCategory(const std::string& name) override;
+
+    private:
+        ReadStreamInterface& inner();
+        bool decompressNextChunk();
+
+        const uint8_t* mData = nullptr;
+        size_t mSize = 0;
+        size_t mPosition = 0;
+
+        InnerStreamFactory mInnerStreamFactory;
+        std::unique_ptr<ReadStreamInterface> mInner;
+        std::unique_ptr<z_stream_s> mZStream;
+        std::vector<uint8_t> mChunk;
+    };
+}
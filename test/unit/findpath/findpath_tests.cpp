@@ -186,3 +186,147 @@ TEST(FindPathTests, pathfinderIsLimited)
     EXPECT_EQ(path.size(), 0);
     ASSERT_FALSE(isReachable);
 }
+
+TEST(FindPathTests, reusedContextMatchesFreshContext)
+{
+    FAWorld::LevelImplStub small(basicMap());
+    FAWorld::LevelImplStub large(Map{500, std::vector<int>(500, 0)});
+
+    FAWorld::PathFindContext reused;
+    bool isReachable = false;
+
+    // Alternate between levels of different sizes, so the context has to cope with both resizing and stale entries from earlier searches
+    for (int32_t i = 0; i < 3; i++)
+    {
+        FAWorld::PathFindContext fresh;
+        bool freshIsReachable = false;
+
+        ASSERT_EQ(reused.pathFind(&small, nullptr, Point(2, 3), Point(18, 5), isReachable, false),
+                  fresh.pathFind(&small, nullptr, Point(2, 3), Point(18, 5), freshIsReachable, false));
+        ASSERT_TRUE(isReachable);
+
+        ASSERT_EQ(reused.pathFind(&small, nullptr, Point(18, 10), Point(10, 10), isReachable, false).size(), 14);
+        ASSERT_TRUE(isReachable);
+
+        ASSERT_EQ(reused.pathFind(&large, nullptr, Point(0, 0), Point(499, 499), isReachable, false).size(), 500);
+        ASSERT_TRUE(isReachable);
+    }
+}
+
+namespace
+{
+    int32_t pathCost(const Points& path)
+    {
+        int32_t cost = 0;
+        for (size_t i = 1; i < path.size(); i++)
+            cost += (path[i].x != path[i - 1].x && path[i].y != path[i - 1].y) ? 14 : 10;
+        return cost;
+    }
+
+    bool isWalkablePath(const FAWorld::LevelImplStub& level, const Points& path)
+    {
+        for (size_t i = 0; i < path.size(); i++)
+        {
+            if (!level.isPassable(path[i], nullptr))
+                return false;
+            if (i > 0 && (std::abs(path[i].x - path[i - 1].x) > 1 || std::abs(path[i].y - path[i - 1].y) > 1 || path[i] == path[i - 1]))
+                return false;
+        }
+        return true;
+    }
+}
+
+TEST_P(FindPathPatternsTest, jumpPointSearchMatchesAStarCost)
+{
+    bool jumpPointIsReachable = false;
+    auto aStarPath = FAWorld::pathFind(level.get(), nullptr, GetParam().start, GetParam().goal, isReachable, false);
+    auto jumpPointPath =
+        FAWorld::pathFind(level.get(), nullptr, GetParam().start, GetParam().goal, jumpPointIsReachable, false, FAWorld::PathFindMode::JumpPoint);
+
+    ASSERT_TRUE(jumpPointIsReachable);
+    ASSERT_TRUE(isWalkablePath(*level, jumpPointPath));
+    ASSERT_EQ(jumpPointPath.front(), GetParam().start);
+    ASSERT_EQ(aStarPath.back(), jumpPointPath.back());
+    ASSERT_EQ(pathCost(aStarPath), pathCost(jumpPointPath));
+}
+
+TEST(FindPathTests, jumpPointSearchMatchesAStarOnRandomMaps)
+{
+    const int32_t mapSize = 40;
+    uint32_t seed = 12345;
+    auto next = [&seed]() {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 16) & 0x7fff;
+    };
+
+    for (int32_t mapIndex = 0; mapIndex < 20; mapIndex++)
+    {
+        Map map{mapSize, std::vector<int>(mapSize, 0)};
+        for (auto& row : map)
+            for (auto& tile : row)
+                tile = next() % 100 < 30 ? 1 : 0;
+
+        FAWorld::LevelImplStub level(map);
+
+        for (int32_t pathIndex = 0; pathIndex < 10; pathIndex++)
+        {
+            Point start(next() % mapSize, next() % mapSize);
+            Point goal(next() % mapSize, next() % mapSize);
+            map[start.y][start.x] = 0;
+            map[goal.y][goal.x] = 0;
+            FAWorld::LevelImplStub openedLevel(map);
+
+            bool aStarIsReachable = false;
+            bool jumpPointIsReachable = false;
+            auto aStarPath = FAWorld::pathFind(&openedLevel, nullptr, start, goal, aStarIsReachable, false);
+            auto jumpPointPath = FAWorld::pathFind(&openedLevel, nullptr, start, goal, jumpPointIsReachable, false, FAWorld::PathFindMode::JumpPoint);
+
+            if (!aStarIsReachable)
+                continue;
+
+            ASSERT_TRUE(jumpPointIsReachable);
+            ASSERT_TRUE(isWalkablePath(openedLevel, jumpPointPath));
+            ASSERT_EQ(jumpPointPath.front(), start);
+            ASSERT_EQ(jumpPointPath.back(), goal);
+            ASSERT_EQ(pathCost(aStarPath), pathCost(jumpPointPath));
+        }
+    }
+}
+
+TEST(FindPathTests, jumpPointSearchFindsLongPathsThatAStarGivesUpOn)
+{
+    // Corridors running the width of the map, joined alternately at either end, so the only path visits nearly every tile
+    const int32_t mapSize = 100;
+    Map map{mapSize, std::vector<int>(mapSize, 0)};
+    for (int32_t y = 1; y < mapSize; y += 2)
+    {
+        for (int32_t x = 0; x < mapSize; x++)
+            map[y][x] = 1;
+        map[y][(y / 2) % 2 == 0 ? mapSize - 1 : 0] = 0;
+    }
+
+    FAWorld::LevelImplStub level(map);
+    const Point start{0, 0};
+    const Point goal{0, mapSize - 2};
+
+    bool isReachable = false;
+    FAWorld::pathFind(&level, nullptr, start, goal, isReachable, false);
+    ASSERT_FALSE(isReachable);
+
+    auto path = FAWorld::pathFind(&level, nullptr, start, goal, isReachable, false, FAWorld::PathFindMode::JumpPoint);
+    ASSERT_TRUE(isReachable);
+    ASSERT_TRUE(isWalkablePath(level, path));
+    ASSERT_EQ(path.back(), goal);
+}
+
+TEST(FindPathTests, jumpPointSearchStopsNextToUnpassableGoal)
+{
+    FAWorld::LevelImplStub level(basicMap());
+
+    bool isReachable = false;
+    auto path = FAWorld::pathFind(&level, nullptr, Point(2, 5), Point(14, 5), isReachable, false, FAWorld::PathFindMode::JumpPoint);
+
+    ASSERT_TRUE(isReachable);
+    ASSERT_TRUE(isWalkablePath(level, path));
+    ASSERT_EQ(path.back(), Point(13, 5));
+}
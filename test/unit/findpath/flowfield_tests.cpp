@@ -0,0 +1,83 @@
+#include "levelimplstub.h"
+#include <faworld/findpath.h>
+#include <faworld/flowfield.h>
+#include <gtest/gtest.h>
+
+using Point = Misc::Point;
+using Points = Misc::Points;
+
+namespace
+{
+    using Map = std::vector<std::vector<int>>;
+
+    Map wallMap()
+    {
+        return {{0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, //
+                {0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, //
+                {0, 1, 1, 1, 1, 1, 1, 1, 0, 0}, //
+                {0, 0, 0, 0, 0, 0, 0, 1, 0, 0}, //
+                {0, 0, 0, 0, 0, 0, 0, 1, 0, 0}, //
+                {0, 0, 0, 0, 0, 0, 0, 0, 0, 0}};
+    }
+}
+
+TEST(FlowFieldTests, distancesMatchPathCosts)
+{
+    FAWorld::LevelImplStub level(wallMap());
+    FAWorld::FlowField field;
+    field.build(level, Point(4, 0));
+
+    // Every tile's distance is the cost of the best path to the source
+    for (int32_t y = 0; y < level.height(); y++)
+    {
+        for (int32_t x = 0; x < level.width(); x++)
+        {
+            if (!level.isPassable(Point(x, y), nullptr) || Point(x, y) == Point(4, 0))
+                continue;
+
+            bool isReachable = false;
+            auto path = FAWorld::pathFind(&level, nullptr, Point(x, y), Point(4, 0), isReachable, false);
+            ASSERT_TRUE(isReachable);
+
+            int32_t cost = 0;
+            for (size_t i = 1; i < path.size(); i++)
+                cost += (path[i].x != path[i - 1].x && path[i].y != path[i - 1].y) ? 14 : 10;
+            ASSERT_EQ(field.distance(Point(x, y)), cost);
+        }
+    }
+
+    ASSERT_EQ(field.distance(Point(3, 2)), FAWorld::FlowField::UNREACHABLE);
+}
+
+TEST(FlowFieldTests, followingStepsReachesSource)
+{
+    FAWorld::LevelImplStub level(wallMap());
+    FAWorld::FlowField field;
+    field.build(level, Point(4, 0));
+
+    Point current(4, 4);
+    Point next;
+    int32_t steps = 0;
+    while (field.nextStep(level, nullptr, current, next))
+    {
+        ASSERT_LT(field.distance(next), field.distance(current));
+        current = next;
+        steps++;
+    }
+
+    ASSERT_EQ(current, Point(4, 0));
+    ASSERT_EQ(steps, 8);
+}
+
+TEST(FlowFieldTests, limitedToRadius)
+{
+    FAWorld::LevelImplStub level(Map{100, std::vector<int>(100, 0)});
+    FAWorld::FlowField field;
+    field.build(level, Point(50, 50));
+
+    ASSERT_EQ(field.distance(Point(50 + FAWorld::FlowField::RADIUS, 50)), FAWorld::FlowField::RADIUS * 10);
+    ASSERT_EQ(field.distance(Point(50 + FAWorld::FlowField::RADIUS + 1, 50)), FAWorld::FlowField::UNREACHABLE);
+
+    Point next;
+    ASSERT_FALSE(field.nextStep(level, nullptr, Point(0, 0), next));
+}
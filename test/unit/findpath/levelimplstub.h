@@ -12,6 +12,7 @@ namespace FAWorld
         int32_t width() const override { return map.empty() ? 0 : map[0].size(); }
         int32_t height() const override { return map.size(); }
         bool isPassable(const Misc::Point& point, const FAWorld::Actor*) const override { return map[point.y][point.x] == 0; }
+        bool isTerrainPassable(const Misc::Point& point) const override { return map[point.y][point.x] == 0; }
 
     private:
         const std::vector<std::vector<int>> map;
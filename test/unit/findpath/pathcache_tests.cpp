@@ -0,0 +1,46 @@
+#include <faworld/pathcache.h>
+#include <gtest/gtest.h>
+
+using Point = Misc::Point;
+
+TEST(PathCacheTests, returnsStoredResult)
+{
+    FAWorld::PathCache cache;
+    FAWorld::PathCache::Result result;
+
+    ASSERT_FALSE(cache.lookup(Point(1, 2), Point(30, 40), result));
+
+    cache.store(Point(1, 2), Point(30, 40), FAWorld::PathCache::Result{true, Point(10, 9)});
+
+    ASSERT_TRUE(cache.lookup(Point(1, 2), Point(30, 40), result));
+    ASSERT_TRUE(result.found);
+    ASSERT_EQ(result.waypoint, Point(10, 9));
+
+    ASSERT_FALSE(cache.lookup(Point(30, 40), Point(1, 2), result));
+    ASSERT_FALSE(cache.lookup(Point(1, 2), Point(30, 41), result));
+}
+
+TEST(PathCacheTests, invalidateDropsEverything)
+{
+    FAWorld::PathCache cache;
+    FAWorld::PathCache::Result result;
+
+    cache.store(Point(1, 2), Point(30, 40), FAWorld::PathCache::Result{false, Point()});
+    ASSERT_TRUE(cache.lookup(Point(1, 2), Point(30, 40), result));
+    ASSERT_FALSE(result.found);
+
+    uint32_t epoch = cache.getEpoch();
+    cache.invalidate();
+
+    ASSERT_NE(cache.getEpoch(), epoch);
+    ASSERT_FALSE(cache.lookup(Point(1, 2), Point(30, 40), result));
+}
+
+TEST(PathCacheTests, emptyCacheNeverMatches)
+{
+    FAWorld::PathCache cache;
+    FAWorld::PathCache::Result result;
+
+    // Default constructed entries have zeroed points, which must not look like a stored (0, 0) -> (0, 0) lookup
+    ASSERT_FALSE(cache.lookup(Point(0, 0), Point(0, 0), result));
+}
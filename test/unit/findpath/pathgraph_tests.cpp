@@ -0,0 +1,132 @@
+#include "levelimplstub.h"
+#include <algorithm>
+#include <faworld/findpath.h>
+#include <faworld/pathgraph.h>
+#include <gtest/gtest.h>
+
+using Point = Misc::Point;
+using Points = Misc::Points;
+
+namespace
+{
+    using Map = std::vector<std::vector<int>>;
+
+    // A wall across the middle of the map, with a single gap that can be opened or closed like a door
+    Map dividedMap(bool doorOpen)
+    {
+        Map map{100, std::vector<int>(100, 0)};
+        for (int32_t x = 0; x < 100; x++)
+            map[47][x] = 1;
+        map[47][63] = doorOpen ? 0 : 1;
+        return map;
+    }
+
+    // Follows an abstract path one segment at a time, the same way MovementHandler does
+    Points walkAbstractPath(FAWorld::LevelImplStub& level, FAWorld::PathGraph& graph, Point start, Point goal)
+    {
+        Points path{start};
+        Point waypoint;
+        while (graph.findNextWaypoint(level, path.back(), goal, waypoint))
+        {
+            bool isReachable = false;
+            auto segment = FAWorld::pathFind(&level, nullptr, path.back(), waypoint, isReachable, false, FAWorld::PathFindMode::JumpPoint);
+            if (!isReachable || segment.size() <= 1)
+                return {};
+            path.insert(path.end(), segment.begin() + 1, segment.end());
+        }
+
+        bool isReachable = false;
+        auto segment = FAWorld::pathFind(&level, nullptr, path.back(), goal, isReachable, false, FAWorld::PathFindMode::JumpPoint);
+        if (!isReachable)
+            return {};
+        path.insert(path.end(), segment.begin() + 1, segment.end());
+        return path;
+    }
+}
+
+TEST(PathGraphTests, abstractPathEndsAtGoal)
+{
+    FAWorld::LevelImplStub level(Map{100, std::vector<int>(100, 0)});
+    FAWorld::PathGraph graph;
+    graph.build(level);
+
+    auto path = graph.findAbstractPath(level, Point(3, 4), Point(95, 90));
+
+    ASSERT_FALSE(path.empty());
+    ASSERT_EQ(path.back(), Point(95, 90));
+}
+
+TEST(PathGraphTests, noAbstractPathThroughClosedDoor)
+{
+    FAWorld::LevelImplStub level(dividedMap(false));
+    FAWorld::PathGraph graph;
+    graph.build(level);
+
+    ASSERT_TRUE(graph.findAbstractPath(level, Point(10, 10), Point(10, 90)).empty());
+}
+
+TEST(PathGraphTests, rebuildAreaMatchesFullBuild)
+{
+    FAWorld::LevelImplStub closed(dividedMap(false));
+    FAWorld::LevelImplStub open(dividedMap(true));
+
+    FAWorld::PathGraph rebuilt;
+    rebuilt.build(closed);
+    rebuilt.rebuildArea(open, Point(62, 46), Point(64, 48));
+
+    FAWorld::PathGraph fresh;
+    fresh.build(open);
+
+    auto path = rebuilt.findAbstractPath(open, Point(10, 10), Point(10, 90));
+    ASSERT_FALSE(path.empty());
+    ASSERT_EQ(path, fresh.findAbstractPath(open, Point(10, 10), Point(10, 90)));
+
+    // And closing it again
+    rebuilt.rebuildArea(closed, Point(62, 46), Point(64, 48));
+    ASSERT_TRUE(rebuilt.findAbstractPath(closed, Point(10, 10), Point(10, 90)).empty());
+}
+
+TEST(PathGraphTests, segmentsJoinUpIntoWalkablePath)
+{
+    FAWorld::LevelImplStub level(dividedMap(true));
+    FAWorld::PathGraph graph;
+    graph.build(level);
+
+    auto path = walkAbstractPath(level, graph, Point(10, 10), Point(10, 90));
+
+    ASSERT_FALSE(path.empty());
+    ASSERT_EQ(path.back(), Point(10, 90));
+    ASSERT_NE(std::find(path.begin(), path.end(), Point(63, 47)), path.end());
+    for (size_t i = 1; i < path.size(); i++)
+    {
+        ASSERT_TRUE(level.isPassable(path[i], nullptr));
+        ASSERT_LE(std::abs(path[i].x - path[i - 1].x), 1);
+        ASSERT_LE(std::abs(path[i].y - path[i - 1].y), 1);
+    }
+}
+
+TEST(PathGraphTests, noWaypointWithinOneCluster)
+{
+    FAWorld::LevelImplStub level(Map{100, std::vector<int>(100, 0)});
+    FAWorld::PathGraph graph;
+    graph.build(level);
+
+    Point waypoint;
+    ASSERT_FALSE(graph.findNextWaypoint(level, Point(1, 1), Point(8, 8), waypoint));
+    ASSERT_EQ(graph.findAbstractPath(level, Point(1, 1), Point(8, 8)), Points{Point(8, 8)});
+}
+
+TEST(PathGraphTests, noWaypointForOffMapPoints)
+{
+    FAWorld::LevelImplStub level(Map{100, std::vector<int>(100, 0)});
+    FAWorld::PathGraph graph;
+    graph.build(level);
+
+    // Clicking past the edge of the map gives tiles like these
+    Point waypoint;
+    ASSERT_FALSE(graph.findNextWaypoint(level, Point(50, 95), Point(55, 103), waypoint));
+    ASSERT_FALSE(graph.findNextWaypoint(level, Point(50, 50), Point(-3, 50), waypoint));
+    ASSERT_FALSE(graph.findNextWaypoint(level, Point(100, 50), Point(10, 10), waypoint));
+    ASSERT_TRUE(graph.findAbstractPath(level, Point(50, 95), Point(55, 103)).empty());
+    ASSERT_TRUE(graph.findAbstractPath(level, Point(50, 50), Point(-3, 50)).empty());
+}
@@ -0,0 +1,40 @@
+#include <engine/net/inputdelay.h>
+#include <gtest/gtest.h>
+
+TEST(InputDelay, TestTicksNeeded)
+{
+    ASSERT_EQ(Engine::InputDelay::ticksNeeded(0, 0), 0);
+
+    // Anything at all is rounded up to a whole tick
+    ASSERT_EQ(Engine::InputDelay::ticksNeeded(2, 0), 1);
+
+    // 100ms one way, and 2 * 25ms for jitter, is 150ms, or 9 ticks
+    ASSERT_EQ(Engine::InputDelay::ticksNeeded(200, 25), 9);
+}
+
+TEST(InputDelay, TestAdapts)
+{
+    Engine::InputDelay delay;
+    ASSERT_EQ(delay.get(), 0);
+
+    // Goes up straight away, but never past the maximum
+    delay.update(3);
+    ASSERT_EQ(delay.get(), 3);
+    delay.update(1000);
+    ASSERT_EQ(delay.get(), Engine::InputDelay::MAX_TICKS);
+
+    // Comes down one tick at a time, and only once less has been needed for a while
+    for (FAWorld::Tick i = 0; i < Engine::InputDelay::DECREASE_INTERVAL - 1; i++)
+        delay.update(0);
+    ASSERT_EQ(delay.get(), Engine::InputDelay::MAX_TICKS);
+
+    delay.update(0);
+    ASSERT_EQ(delay.get(), Engine::InputDelay::MAX_TICKS - 1);
+
+    // A single spike resets the countdown
+    for (FAWorld::Tick i = 0; i < Engine::InputDelay::DECREASE_INTERVAL - 1; i++)
+        delay.update(0);
+    delay.update(Engine::InputDelay::MAX_TICKS - 1);
+    delay.update(0);
+    ASSERT_EQ(delay.get(), Engine::InputDelay::MAX_TICKS - 1);
+}
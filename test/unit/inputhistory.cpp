@@ -0,0 +1,28 @@
+#include <engine/net/inputhistory.h>
+#include <gtest/gtest.h>
+
+TEST(InputHistory, TestRingBuffer)
+{
+    Engine::InputHistory history(4);
+    ASSERT_FALSE(history.contains(0));
+
+    history.startTick(0).emplace_back(FAWorld::PlayerInput::TargetTileData{1, 2}, 7);
+    history.startTick(1);
+
+    ASSERT_TRUE(history.contains(0));
+    ASSERT_TRUE(history.contains(1));
+    ASSERT_EQ(history.get(0).size(), 1u);
+    ASSERT_EQ(history.get(0)[0].mActorId, 7);
+    ASSERT_TRUE(history.get(1).empty());
+
+    // Storing a tick doesn't allocate, as long as it fits in the space reserved up front
+    const FAWorld::PlayerInput* storage = history.get(0).data();
+    std::vector<FAWorld::PlayerInput>& reused = history.startTick(Engine::InputHistory::CAPACITY);
+    reused.resize(4);
+    ASSERT_EQ(reused.data(), storage);
+
+    // tick 0 shares a slot with tick CAPACITY, so it's gone now
+    ASSERT_FALSE(history.contains(0));
+    ASSERT_TRUE(history.contains(Engine::InputHistory::CAPACITY));
+    ASSERT_TRUE(history.contains(1));
+}
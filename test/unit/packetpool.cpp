@@ -0,0 +1,40 @@
+#include <engine/net/packetpool.h>
+#include <gtest/gtest.h>
+
+TEST(PacketPool, TestBuffersAreReused)
+{
+    Engine::PacketPool pool;
+
+    Serial::PackedWriteStream& stream = pool.startPacket();
+    stream.write(uint32_t(300));
+    ENetPacket* first = pool.finishPacket(ENET_PACKET_FLAG_UNSEQUENCED);
+
+    // The packet points straight at the pooled buffer, nothing is copied
+    ASSERT_EQ(first->data, stream.getData().first);
+    ASSERT_EQ(first->dataLength, 2u);
+    ASSERT_TRUE(first->flags & ENET_PACKET_FLAG_UNSEQUENCED);
+
+    // While the first packet is alive, the next one needs a buffer of its own
+    pool.startPacket().write(uint8_t(1));
+    ENetPacket* second = pool.finishPacket(ENET_PACKET_FLAG_RELIABLE);
+    ASSERT_NE(second->data, first->data);
+    ASSERT_EQ(pool.getBufferCount(), 2u);
+
+    // Destroying a packet gives its buffer back, and it's handed out again with its capacity intact
+    uint8_t* secondData = second->data;
+    enet_packet_destroy(first);
+    enet_packet_destroy(second);
+
+    Serial::PackedWriteStream& reused = pool.startPacket();
+    ASSERT_EQ(reused.getCurrentSize(), 0u);
+    reused.write(uint8_t(2));
+    ENetPacket* third = pool.finishPacket(0);
+    ASSERT_EQ(third->data, secondData);
+    ASSERT_EQ(pool.getBufferCount(), 2u);
+    enet_packet_destroy(third);
+
+    // A stream that was started but never finished is handed out again
+    Serial::PackedWriteStream& abandoned = pool.startPacket();
+    ASSERT_EQ(&pool.startPacket(), &abandoned);
+    ASSERT_EQ(pool.getBufferCount(), 2u);
+}
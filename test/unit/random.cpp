@@ -40,8 +40,10 @@ TEST(Random, TestSaveLoadRng)
     };
     UNUSED_PARAM(generateTestData);
 
+    // The rng state is the same for every save version, so just patch in the current one
     std::string savedData =
-        "U32 3\nSTRING 6721\n2260313690 348938374 3392255680 2909033704 140638832 1016917445 4051655600 976942074 1628339371 932989997 417988570 3106230116 "
+        "U32 " + std::to_string(Serial::CurrentSaveVersion) +
+        "\nSTRING 6721\n2260313690 348938374 3392255680 2909033704 140638832 1016917445 4051655600 976942074 1628339371 932989997 417988570 3106230116 "
         "3847402493 2846838083 1854065059 2365406610 631390710 3006558680 1855109059 230064328 758538135 1999313224 2345696623 4174662269 280561112 1706268812 "
         "4182435209 1014638053 610687375 2331525695 3432349290 1302213857 2461808965 1211193860 3120004290 159403718 785407708 1103582039 2181742160 "
         "4003474818 3333684546 2164025542 3329631014 3331897623 44841503 2124190575 4103716897 1985760015 3231349092 2579223365 2045506447 1684183393 "
@@ -0,0 +1,166 @@
+#include <cstdio>
+#include <diabloexe/diabloexe.h>
+#include <engine/net/netcommon.h>
+#include <fasavegame/gameloader.h>
+#include <fasavegame/objectidmapper.h>
+#include <fasavegame/savegame.h>
+#include <fasavegame/savejournal.h>
+#include <faworld/world.h>
+#include <gtest/gtest.h>
+#include <serial/binarystream.h>
+#include <vector>
+
+TEST(SaveGame, TestHeaderRoundTrip)
+{
+    FASaveGame::SaveGameHeader header;
+    header.characterName = "A name that is much too long to fit in the header";
+    header.characterClass = FAWorld::PlayerClass::rogue;
+    header.characterLevel = 12;
+    header.dungeonLevel = 7;
+    header.timestamp = 1583452800;
+    header.payloadSize = 123456;
+
+    Serial::BinaryWriteStream stream;
+    header.save(stream);
+
+    auto data = stream.getData();
+    ASSERT_EQ(data.second, FASaveGame::SaveGameHeader::SIZE);
+
+    std::optional<FASaveGame::SaveGameHeader> loaded = FASaveGame::SaveGameHeader::load(data.first, data.second);
+    ASSERT_TRUE(loaded);
+    ASSERT_EQ(loaded->saveVersion, Serial::CurrentSaveVersion);
+    ASSERT_EQ(loaded->characterName, header.characterName.substr(0, FASaveGame::SaveGameHeader::NAME_SIZE));
+    ASSERT_EQ(loaded->characterClass, FAWorld::PlayerClass::rogue);
+    ASSERT_EQ(loaded->characterLevel, 12);
+    ASSERT_EQ(loaded->dungeonLevel, 7);
+    ASSERT_EQ(loaded->timestamp, 1583452800);
+    ASSERT_EQ(loaded->payloadSize, 123456u);
+}
+
+TEST(SaveGame, TestReadHeaderOnly)
+{
+    FASaveGame::SaveGameHeader header;
+    header.characterName = "Test";
+    header.payloadSize = 4;
+
+    Serial::BinaryWriteStream stream;
+    header.save(stream);
+    stream.write(uint32_t(0xdeadbeef));
+
+    const char* path = "test_savegame_header.sav";
+    {
+        auto data = stream.getData();
+        FILE* f = fopen(path, "wb");
+        fwrite(data.first, 1, data.second, f);
+        fclose(f);
+    }
+
+    std::optional<FASaveGame::SaveGameHeader> loaded = FASaveGame::readSaveGameHeader(path);
+    remove(path);
+
+    ASSERT_TRUE(loaded);
+    ASSERT_EQ(loaded->characterName, "Test");
+    ASSERT_EQ(loaded->payloadSize, 4u);
+
+    ASSERT_FALSE(FASaveGame::readSaveGameHeader("this_file_does_not_exist.sav"));
+}
+
+TEST(SaveGame, TestObjectIdMapper)
+{
+    int32_t a = 1;
+    int32_t b = 2;
+
+    FASaveGame::ObjectIdMapper mapper;
+    mapper.addClass(FASaveGame::TypeId::actor, [&](FASaveGame::GameLoader&) { return &a; });
+    mapper.addClass(FASaveGame::TypeId::baseState, [&](FASaveGame::GameLoader&) { return &b; });
+
+    Serial::BinaryWriteStream writeStream;
+    FASaveGame::GameSaver saver(writeStream);
+    auto data = writeStream.getData();
+
+    Serial::BinaryReadStream readStream(data.first, data.second);
+    FASaveGame::GameLoader loader(readStream);
+
+    ASSERT_EQ(mapper.construct(FASaveGame::TypeId::actor, loader), &a);
+    ASSERT_EQ(mapper.construct(FASaveGame::TypeId::baseState, loader), &b);
+}
+
+TEST(SaveGame, TestJournal)
+{
+    DiabloExe::DiabloExe exe("");
+    FAWorld::World world(exe, 1234);
+    for (int32_t i = 0; i < 3; i++)
+        world.insertLevel(i, nullptr);
+
+    const char* path = "test_savegame.journal";
+    FASaveGame::SaveJournal journal(path);
+
+    auto loadTick = [&]() {
+        FAWorld::World loaded(exe, 0);
+        if (!FASaveGame::SaveJournal::load(path, loaded))
+            return FAWorld::Tick(-1);
+
+        EXPECT_EQ(loaded.getLevels().size(), 3u);
+        return loaded.getCurrentTick();
+    };
+
+    ASSERT_TRUE(journal.append(world));
+    ASSERT_EQ(loadTick(), 0);
+
+    world.update(false, {});
+    ASSERT_TRUE(journal.append(world));
+    ASSERT_EQ(loadTick(), 1);
+
+    // simulate a crash halfway through writing an entry, we should just get the last complete one
+    world.update(false, {});
+    ASSERT_TRUE(journal.append(world));
+    {
+        std::vector<uint8_t> data;
+        FILE* f = fopen(path, "rb");
+        for (int c; (c = fgetc(f)) != EOF;)
+            data.push_back(uint8_t(c));
+        fclose(f);
+
+        f = fopen(path, "wb");
+        fwrite(data.data(), 1, data.size() - 3, f);
+        fclose(f);
+    }
+    ASSERT_EQ(loadTick(), 1);
+
+    remove(path);
+    ASSERT_FALSE(FASaveGame::SaveJournal::load(path, world));
+}
+
+TEST(SaveGame, TestPendingLevels)
+{
+    DiabloExe::DiabloExe exe("");
+    FAWorld::World world(exe, 1234);
+    for (int32_t i = 0; i < 3; i++)
+        world.insertLevel(i, nullptr);
+    world.update(false, {});
+
+    auto writeLevel = [&](int32_t levelIndex) {
+        return Engine::WorldChunkWriter([&](FASaveGame::GameSaver& saver) { world.saveLevel(saver, levelIndex); }).getCompressedData();
+    };
+
+    // Each chunk is compressed separately, so they can be loaded in any order, at any time
+    Engine::WorldChunkReader globalsReader(Engine::WorldChunkWriter([&](FASaveGame::GameSaver& saver) { world.saveGlobals(saver); }).getCompressedData());
+    Engine::WorldChunkReader levelReader(writeLevel(0));
+
+    FAWorld::World loaded(exe, 0);
+    loaded.load(globalsReader.getLoader(), {{0, &levelReader.getLoader()}});
+    loaded.addPendingLevel(1);
+    loaded.addPendingLevel(2);
+
+    ASSERT_EQ(loaded.getCurrentTick(), 1);
+    ASSERT_EQ(loaded.getLevels().size(), 3u);
+    ASSERT_FALSE(loaded.isLevelPending(0));
+    ASSERT_TRUE(loaded.isLevelPending(2));
+
+    Engine::WorldChunkReader pendingReader(writeLevel(2));
+    loaded.loadPendingLevel(2, pendingReader.getLoader());
+
+    ASSERT_FALSE(loaded.isLevelPending(2));
+    ASSERT_TRUE(loaded.isLevelPending(1));
+    ASSERT_EQ(loaded.getLevels().size(), 3u);
+}
@@ -0,0 +1,241 @@
+#include <gtest/gtest.h>
+#include <limits>
+#include <serial/binarystream.h>
+#include <serial/hashstream.h>
+#include <serial/loader.h>
+#include <serial/packedstream.h>
+#include <serial/textstream.h>
+#include <serial/zlibstream.h>
+
+namespace
+{
+    void saveTestValues(Serial::Saver& saver)
+    {
+        Serial::ScopedCategorySaver cat("Test", saver);
+
+        saver.save(true);
+        saver.save(false);
+        saver.save(std::numeric_limits<int64_t>::min());
+        saver.save(std::numeric_limits<uint64_t>::max());
+        saver.save(int32_t(-123456789));
+        saver.save(uint32_t(3000000000u));
+        saver.save(int16_t(-1234));
+        saver.save(uint16_t(65000));
+        saver.save(int8_t(-100));
+        saver.save(uint8_t(250));
+        saver.save(std::string("multi\nline string"));
+        saver.save(std::string());
+    }
+
+    void checkTestValues(Serial::Loader& loader)
+    {
+        ASSERT_EQ(loader.load<bool>(), true);
+        ASSERT_EQ(loader.load<bool>(), false);
+        ASSERT_EQ(loader.load<int64_t>(), std::numeric_limits<int64_t>::min());
+        ASSERT_EQ(loader.load<uint64_t>(), std::numeric_limits<uint64_t>::max());
+        ASSERT_EQ(loader.load<int32_t>(), -123456789);
+        ASSERT_EQ(loader.load<uint32_t>(), 3000000000u);
+        ASSERT_EQ(loader.load<int16_t>(), -1234);
+        ASSERT_EQ(loader.load<uint16_t>(), 65000);
+        ASSERT_EQ(loader.load<int8_t>(), -100);
+        ASSERT_EQ(loader.load<uint8_t>(), 250);
+        ASSERT_EQ(loader.load<std::string>(), "multi\nline string");
+        ASSERT_EQ(loader.load<std::string>(), "");
+    }
+}
+
+TEST(Serial, TestTextRoundTrip)
+{
+    Serial::TextWriteStream writeStream;
+    Serial::Saver saver(writeStream);
+    saveTestValues(saver);
+
+    auto data = writeStream.getData();
+    Serial::TextReadStream readStream(std::string(reinterpret_cast<const char*>(data.first), data.second));
+    Serial::Loader loader(readStream);
+    checkTestValues(loader);
+}
+
+TEST(Serial, TestTextCategories)
+{
+    Serial::TextWriteStream writeStream;
+    Serial::Saver saver(writeStream);
+    {
+        Serial::ScopedCategorySaver outer("Outer", saver);
+        saver.save(uint32_t(1));
+        {
+            Serial::ScopedCategorySaver inner("Inner", saver);
+            saver.save(uint32_t(2));
+        }
+    }
+
+    auto data = writeStream.getData();
+    Serial::TextReadStream readStream(std::string(reinterpret_cast<const char*>(data.first), data.second));
+    Serial::Loader loader(readStream);
+
+    loader.startCategory("Outer");
+    ASSERT_EQ(loader.load<uint32_t>(), 1u);
+    // categories are skipped when reading values
+    ASSERT_EQ(loader.load<uint32_t>(), 2u);
+    loader.endCategory("Inner");
+    loader.endCategory("Outer");
+    ASSERT_TRUE(readStream.isAtEnd());
+}
+
+TEST(Serial, TestBinaryRoundTrip)
+{
+    Serial::BinaryWriteStream writeStream;
+    Serial::Saver saver(writeStream);
+    saveTestValues(saver);
+
+    auto data = writeStream.getData();
+    Serial::BinaryReadStream readStream(data.first, data.second);
+    Serial::Loader loader(readStream);
+    checkTestValues(loader);
+
+    ASSERT_EQ(readStream.getPosition(), data.second);
+}
+
+TEST(Serial, TestBinaryIsLittleEndian)
+{
+    Serial::BinaryWriteStream writeStream;
+    writeStream.write(uint32_t(0x01020304));
+    writeStream.write(int16_t(-2));
+
+    auto data = writeStream.getData();
+    ASSERT_EQ(data.second, 6u);
+
+    std::vector<uint8_t> expected = {0x04, 0x03, 0x02, 0x01, 0xfe, 0xff};
+    ASSERT_EQ(std::vector<uint8_t>(data.first, data.first + data.second), expected);
+}
+
+TEST(Serial, TestZlibRoundTrip)
+{
+    Serial::BinaryWriteStream binaryStream;
+    Serial::ZlibWriteStream writeStream(binaryStream);
+    Serial::Saver saver(writeStream);
+
+    // enough data to span several chunks
+    for (uint32_t i = 0; i < Serial::ZlibWriteStream::CHUNK_SIZE; i++)
+        saver.save(i);
+    saveTestValues(saver);
+
+    auto data = writeStream.getData();
+    ASSERT_LT(data.second, size_t(Serial::ZlibWriteStream::CHUNK_SIZE) * sizeof(uint32_t));
+
+    Serial::ZlibReadStream readStream(
+        data.first, data.second, [](const uint8_t* chunk, size_t size) { return std::make_unique<Serial::BinaryReadStream>(chunk, size); });
+    Serial::Loader loader(readStream);
+
+    for (uint32_t i = 0; i < Serial::ZlibWriteStream::CHUNK_SIZE; i++)
+        ASSERT_EQ(loader.load<uint32_t>(), i);
+    checkTestValues(loader);
+
+    ASSERT_TRUE(readStream.isAtEnd());
+}
+
+TEST(Serial, TestZlibTextRoundTrip)
+{
+    Serial::TextWriteStream textStream;
+    Serial::ZlibWriteStream writeStream(textStream);
+    Serial::Saver saver(writeStream);
+    saveTestValues(saver);
+
+    auto data = writeStream.getData();
+    Serial::ZlibReadStream readStream(data.first, data.second, [](const uint8_t* chunk, size_t size) {
+        return std::make_unique<Serial::TextReadStream>(std::string(reinterpret_cast<const char*>(chunk), size));
+    });
+    Serial::Loader loader(readStream);
+    checkTestValues(loader);
+}
+
+TEST(Serial, TestZlibDeferredCompressionMatches)
+{
+    auto compress = [](bool deferCompression) {
+        Serial::BinaryWriteStream binaryStream;
+        Serial::ZlibWriteStream writeStream(binaryStream, deferCompression);
+        Serial::Saver saver(writeStream);
+
+        for (uint32_t i = 0; i < Serial::ZlibWriteStream::CHUNK_SIZE; i++)
+            saver.save(i);
+        saveTestValues(saver);
+
+        auto data = writeStream.getData();
+        return std::vector<uint8_t>(data.first, data.first + data.second);
+    };
+
+    // deferring only changes when the compression happens, not what it produces
+    ASSERT_EQ(compress(true), compress(false));
+}
+
+TEST(Serial, TestPackedRoundTrip)
+{
+    Serial::PackedWriteStream writeStream;
+    Serial::Saver saver(writeStream);
+    saveTestValues(saver);
+
+    auto data = writeStream.getData();
+    Serial::PackedReadStream readStream(data.first, data.second);
+    Serial::Loader loader(readStream);
+    checkTestValues(loader);
+
+    ASSERT_EQ(readStream.getPosition(), data.second);
+}
+
+TEST(Serial, TestPackedVarints)
+{
+    Serial::PackedWriteStream writeStream;
+    writeStream.write(uint32_t(127));
+    writeStream.write(uint32_t(300));
+    writeStream.write(int32_t(-1));
+    writeStream.write(int64_t(63));
+    writeStream.write(int64_t(-65));
+
+    auto data = writeStream.getData();
+    std::vector<uint8_t> expected = {0x7f, 0xac, 0x02, 0x01, 0x7e, 0x81, 0x01};
+    ASSERT_EQ(std::vector<uint8_t>(data.first, data.first + data.second), expected);
+
+    Serial::PackedReadStream readStream(data.first, data.second);
+    ASSERT_EQ(readStream.read_uint32_t(), 127u);
+    ASSERT_EQ(readStream.read_uint32_t(), 300u);
+    ASSERT_EQ(readStream.read_int32_t(), -1);
+    ASSERT_EQ(readStream.read_int64_t(), 63);
+    ASSERT_EQ(readStream.read_int64_t(), -65);
+    ASSERT_TRUE(readStream.isAtEnd());
+}
+
+TEST(Serial, TestHashMatchesBinaryData)
+{
+    Serial::BinaryWriteStream binaryStream;
+    {
+        Serial::Saver saver(binaryStream);
+        saveTestValues(saver);
+    }
+
+    Serial::HashWriteStream hashStream;
+    {
+        Serial::Saver saver(hashStream);
+        saveTestValues(saver);
+    }
+
+    // FNV-1a over the bytes the binary stream wrote
+    auto data = binaryStream.getData();
+    uint64_t expected = 14695981039346656037ULL;
+    for (size_t i = 0; i < data.second; i++)
+    {
+        expected ^= data.first[i];
+        expected *= 1099511628211ULL;
+    }
+
+    ASSERT_EQ(hashStream.getCurrentSize(), data.second);
+    ASSERT_EQ(hashStream.getHash(), expected);
+
+    Serial::HashWriteStream changedStream;
+    {
+        Serial::Saver saver(changedStream);
+        saveTestValues(saver);
+        saver.save(uint8_t(0));
+    }
+
+    ASSERT_NE(changedStream.getHash(), hashStream.getHash());
+}
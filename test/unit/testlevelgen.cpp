@@ -34,5 +34,5 @@ TEST(LevelGen, BasicDeterminism)
     }
 
     // feel free to update this hash if you have changed level generation
-    ASSERT_EQ(hash, "21c715f734eef74c05c04fe34b9ed51d");
+    ASSERT_EQ(hash, "ee65d8c56402600527c1e85e71a7f4a0");
 }